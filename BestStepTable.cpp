@@ -0,0 +1,273 @@
+/**
+ * Best Step Table Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "BestStepTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+#include "GameStepStorage.hpp"
+
+unsigned long long BestStepTable::Mix(unsigned long long value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+std::size_t BestStepTable::GetNumberOfBuckets(std::size_t numOfSteps)
+{
+    return (numOfSteps + BEST_STEP_TABLE_BUCKET_SIZE - 1) / BEST_STEP_TABLE_BUCKET_SIZE;
+}
+
+unsigned long long BestStepTable::GetHash(unsigned long long stateKey) const
+{
+    return Mix(stateKey ^ seed);
+}
+
+std::size_t BestStepTable::GetSlot(unsigned long long hash, unsigned int pilot) const
+{
+    return static_cast<std::size_t>(Mix(hash ^ (pilot * 0x9E3779B97F4A7C15ull)) % steps.size());
+}
+
+bool BestStepTable::Place(const std::vector<unsigned long long>& bestSteps)
+{
+    std::size_t numOfSteps = bestSteps.size();
+    std::size_t numOfBuckets = GetNumberOfBuckets(numOfSteps);
+    steps.assign(numOfSteps, 0);
+    pilots.assign(numOfBuckets, 0);
+
+    // Group the states by their buckets
+    std::vector<unsigned long long> hashes(numOfSteps);
+    std::vector<std::size_t> bucketOffsets(numOfBuckets + 1, 0);
+    for (std::size_t index = 0; index < numOfSteps; ++index)
+    {
+        hashes[index] = GetHash(bestSteps[index] >> 16);
+        ++bucketOffsets[hashes[index] % numOfBuckets + 1];
+    }
+    std::partial_sum(bucketOffsets.begin(), bucketOffsets.end(), bucketOffsets.begin());
+
+    std::vector<std::size_t> bucketSteps(numOfSteps);
+    std::vector<std::size_t> nextOffsets(bucketOffsets.begin(), bucketOffsets.end() - 1);
+    for (std::size_t index = 0; index < numOfSteps; ++index)
+    {
+        bucketSteps[nextOffsets[hashes[index] % numOfBuckets]++] = index;
+    }
+
+    // Place the largest buckets first, while most of the slots are free
+    std::vector<std::size_t> buckets(numOfBuckets);
+    std::iota(buckets.begin(), buckets.end(), 0);
+    std::stable_sort(buckets.begin(), buckets.end(), [&bucketOffsets](std::size_t a, std::size_t b)
+    {
+        return bucketOffsets[a + 1] - bucketOffsets[a] > bucketOffsets[b + 1] - bucketOffsets[b];
+    });
+
+    // The last buckets find one of the few free slots in the number of slots tries on average
+    unsigned long long maxPilot = std::min<unsigned long long>(16ull * numOfSteps + 65536, 0xFFFFFFFFull);
+    std::vector<bool> takenSlots(numOfSteps, false);
+    std::vector<std::size_t> slots;
+    for (std::vector<std::size_t>::const_iterator bi = buckets.cbegin(); bi != buckets.cend(); ++bi)
+    {
+        std::size_t first = bucketOffsets[*bi];
+        std::size_t last = bucketOffsets[*bi + 1];
+        if (first == last)
+        {
+            break;
+        }
+
+        // Try the pilots until the states of the bucket get free and different slots
+        unsigned int pilot = 0;
+        while (true)
+        {
+            slots.clear();
+            for (std::size_t index = first; index < last; ++index)
+            {
+                std::size_t slot = GetSlot(hashes[bucketSteps[index]], pilot);
+                if (takenSlots[slot] || std::find(slots.cbegin(), slots.cend(), slot) != slots.cend())
+                {
+                    break;
+                }
+                slots.push_back(slot);
+            }
+
+            if (slots.size() == last - first)
+            {
+                break;
+            }
+            if (pilot == maxPilot)
+            {
+                return false;
+            }
+            ++pilot;
+        }
+
+        pilots[*bi] = pilot;
+        for (std::size_t index = first; index < last; ++index)
+        {
+            takenSlots[slots[index - first]] = true;
+            steps[slots[index - first]] = bestSteps[bucketSteps[index]];
+        }
+    }
+
+    return true;
+}
+
+unsigned long long BestStepTable::CalculateChecksum() const
+{
+    unsigned long long checksum = STORAGE_FILE_CHECKSUM_BASIS;
+    for (std::vector<unsigned int>::const_iterator pi = pilots.cbegin(); pi != pilots.cend(); ++pi)
+    {
+        checksum = (checksum ^ *pi) * 0x100000001B3ull;
+    }
+    for (std::vector<unsigned long long>::const_iterator si = steps.cbegin(); si != steps.cend(); ++si)
+    {
+        checksum = (checksum ^ *si) * 0x100000001B3ull;
+    }
+
+    return checksum;
+}
+
+bool BestStepTable::Build(const std::vector<StorageFileRecord>& records)
+{
+    // Select the step with the best balance of every state (the records of a state follow each other)
+    std::vector<unsigned long long> bestSteps;
+    long long bestBalance = 0;
+    for (std::vector<StorageFileRecord>::const_iterator ri = records.cbegin(); ri != records.cend(); ++ri)
+    {
+        long long balance = GetStepBalance(ri->wins, ri->losses);
+        if (bestSteps.empty() || (bestSteps.back() >> 16) != (ri->key >> 16))
+        {
+            bestSteps.push_back(ri->key);
+            bestBalance = balance;
+        }
+        else if (bestBalance < balance)
+        {
+            bestSteps.back() = ri->key;
+            bestBalance = balance;
+        }
+    }
+
+    for (unsigned int seedIndex = 0; seedIndex < BEST_STEP_TABLE_MAX_NUM_OF_SEEDS; ++seedIndex)
+    {
+        seed = Mix(seedIndex + 1);
+        if (Place(bestSteps))
+        {
+            return true;
+        }
+    }
+
+    steps.clear();
+    pilots.clear();
+    return false;
+}
+
+bool BestStepTable::Load(std::string fileName)
+{
+    std::ifstream file;
+    file.open(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // Check the size of the file before allocating the table
+    BestStepTableFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::streamoff dataSize = 0;
+    if (file.good())
+    {
+        file.seekg(0, std::ios::end);
+        dataSize = static_cast<std::streamoff>(file.tellg()) - static_cast<std::streamoff>(sizeof(header));
+        file.seekg(sizeof(header), std::ios::beg);
+    }
+    if (file.fail() || std::memcmp(header.magic, BEST_STEP_TABLE_FILE_MAGIC, sizeof(header.magic)) != 0
+            || header.version != BEST_STEP_TABLE_FILE_VERSION || header.stepSize != sizeof(unsigned long long)
+            || header.numOfSteps > static_cast<unsigned long long>(dataSize) / sizeof(unsigned long long))
+    {
+        return false;
+    }
+
+    std::size_t numOfSteps = static_cast<std::size_t>(header.numOfSteps);
+    if (static_cast<unsigned long long>(dataSize) != GetNumberOfBuckets(numOfSteps) * sizeof(unsigned int)
+            + numOfSteps * sizeof(unsigned long long))
+    {
+        return false;
+    }
+
+    seed = header.seed;
+    pilots.resize(GetNumberOfBuckets(numOfSteps));
+    steps.resize(numOfSteps);
+    file.read(reinterpret_cast<char*>(pilots.data()), pilots.size() * sizeof(unsigned int));
+    file.read(reinterpret_cast<char*>(steps.data()), steps.size() * sizeof(unsigned long long));
+    if (file.fail() || header.checksum != CalculateChecksum())
+    {
+        steps.clear();
+        pilots.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool BestStepTable::Save(std::string fileName) const
+{
+    std::ofstream file;
+    file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    BestStepTableFileHeader header;
+    std::memcpy(header.magic, BEST_STEP_TABLE_FILE_MAGIC, sizeof(header.magic));
+    header.version = BEST_STEP_TABLE_FILE_VERSION;
+    header.stepSize = sizeof(unsigned long long);
+    header.numOfSteps = steps.size();
+    header.seed = seed;
+    header.checksum = CalculateChecksum();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pilots.data()), pilots.size() * sizeof(unsigned int));
+    file.write(reinterpret_cast<const char*>(steps.data()), steps.size() * sizeof(unsigned long long));
+    file.close();
+
+    return !file.fail();
+}
+
+bool BestStepTable::Find(unsigned long long stateKey, unsigned char* changes0, unsigned char* changes1) const
+{
+    if (steps.empty())
+    {
+        return false;
+    }
+
+    unsigned long long hash = GetHash(stateKey);
+    unsigned long long step = steps[GetSlot(hash, pilots[hash % pilots.size()])];
+    if ((step >> 16) != stateKey)
+    {
+        return false;
+    }
+
+    *changes0 = step >> 8;
+    *changes1 = step;
+    return true;
+}
+
+std::size_t BestStepTable::GetNumberOfSteps() const
+{
+    return steps.size();
+}
+
+std::size_t BestStepTable::GetMemorySize() const
+{
+    return steps.capacity() * sizeof(unsigned long long) + pilots.capacity() * sizeof(unsigned int);
+}
@@ -0,0 +1,192 @@
+/**
+ * Best Step Table Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef BEST_STEP_TABLE_H
+#define BEST_STEP_TABLE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "StorageFile.hpp"
+
+/** Magic of the best step table files */
+const char BEST_STEP_TABLE_FILE_MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'B', 'S' };
+
+/** Version of the best step table file format */
+const unsigned int BEST_STEP_TABLE_FILE_VERSION = 1;
+
+/** Average number of states per bucket of the hash */
+const std::size_t BEST_STEP_TABLE_BUCKET_SIZE = 4;
+
+/** Number of seeds of the hash tried before building fails */
+const unsigned int BEST_STEP_TABLE_MAX_NUM_OF_SEEDS = 16;
+
+/** Header of the best step table files */
+struct BestStepTableFileHeader
+{
+    /** Magic of the file (BEST_STEP_TABLE_FILE_MAGIC) */
+    char magic[8];
+
+    /** Version of the file format */
+    unsigned int version;
+
+    /** Size of a step in bytes */
+    unsigned int stepSize;
+
+    /** Number of steps (states) */
+    unsigned long long numOfSteps;
+
+    /** Seed of the hash */
+    unsigned long long seed;
+
+    /** Checksum of the pilots and the steps */
+    unsigned long long checksum;
+};
+
+/**
+ * Best step table
+ *
+ * Immutable table of the stored step with the best balance of every
+ * state, exported from the storage of a learning AI for playing without
+ * learning. The states are the keys of a minimal perfect hash: a state is
+ * hashed to a bucket, the pilot of the bucket selects the slot of the
+ * state, so finding a state is a single probe of the table of the steps.
+ * The steps are stored with their states (as the keys of the storage
+ * file records), states not in the table are recognized.
+ *
+ * The file is a BestStepTableFileHeader followed by the pilots of the
+ * buckets and the steps of the slots, in the byte order of the host.
+ */
+class BestStepTable
+{
+private:
+    /** Steps of the slots (state << 16 | changes0 << 8 | changes1) */
+    std::vector<unsigned long long> steps;
+
+    /** Pilots of the buckets */
+    std::vector<unsigned int> pilots;
+
+    /** Seed of the hash */
+    unsigned long long seed = 0;
+
+    /**
+     * Mix the bits of a value
+     *
+     * @param[in] value The value
+     *
+     * @return The mixed value (SplitMix64 finalizer)
+     */
+    static unsigned long long Mix(unsigned long long value);
+
+    /**
+     * Get the number of buckets of a number of states
+     *
+     * @param[in] numOfSteps The number of states
+     *
+     * @return The number of buckets
+     */
+    static std::size_t GetNumberOfBuckets(std::size_t numOfSteps);
+
+    /**
+     * Get the hash of a state
+     *
+     * @param[in] stateKey The packed state of the game field
+     *
+     * @return The hash with the seed of the table
+     */
+    unsigned long long GetHash(unsigned long long stateKey) const;
+
+    /**
+     * Get the slot of a state
+     *
+     * @param[in] hash The hash of the state
+     * @param[in] pilot The pilot of the bucket of the state
+     *
+     * @return The index of the slot
+     */
+    std::size_t GetSlot(unsigned long long hash, unsigned int pilot) const;
+
+    /**
+     * Find the pilots of the buckets and place the steps with the seed of the table
+     *
+     * @param[in] bestSteps The best steps of the states
+     *
+     * @return Every bucket has a pilot
+     */
+    bool Place(const std::vector<unsigned long long>& bestSteps);
+
+    /**
+     * Calculate the checksum of the pilots and the steps
+     *
+     * @return The FNV-1a hash of the pilots and the steps
+     */
+    unsigned long long CalculateChecksum() const;
+
+public:
+
+    /**
+     * Build the table
+     *
+     * The step with the best balance is selected for every state (the
+     * one with the smaller key of the equal balances, as LearningAI
+     * selects them).
+     *
+     * @param[in] records The records of the storage sorted by key
+     *
+     * @return Building was successful
+     */
+    bool Build(const std::vector<StorageFileRecord>& records);
+
+    /**
+     * Load the table from file
+     *
+     * @param[in] fileName Filename of the best step table file to load from
+     *
+     * @return Loading was successful
+     */
+    bool Load(std::string fileName);
+
+    /**
+     * Save the table to file
+     *
+     * @param[in] fileName Filename of the best step table file to save to
+     *
+     * @return Saving was successful
+     */
+    bool Save(std::string fileName) const;
+
+    /**
+     * Find the best step of a state
+     *
+     * @param[in] stateKey The packed state of the game field (canonical)
+     * @param[out] changes0 Pointer to store the first change in
+     * @param[out] changes1 Pointer to store the second change in
+     *
+     * @return The state is in the table
+     */
+    bool Find(unsigned long long stateKey, unsigned char* changes0, unsigned char* changes1) const;
+
+    /**
+     * Get the number of steps
+     *
+     * @return The number of steps (states) in the table
+     */
+    std::size_t GetNumberOfSteps() const;
+
+    /**
+     * Get the memory of the table
+     *
+     * @return The number of bytes of the pilots and the steps
+     */
+    std::size_t GetMemorySize() const;
+};
+
+#endif // BEST_STEP_TABLE_H
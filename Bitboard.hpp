@@ -0,0 +1,113 @@
+/**
+ * Bitboard - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "GameConstants.hpp"
+
+/** Set of field places (bit n is set if place n is included) */
+typedef unsigned int Bitboard;
+
+/** Set of mills (bit n is set if mill n is included) */
+typedef unsigned int MillSet;
+
+/** Bitboard of all the field places */
+constexpr Bitboard FULL_BOARD = (1u << NUM_OF_FIELD_PLACES) - 1;
+
+/**
+ * Get the bitboard of a place
+ *
+ * @param[in] place The place
+ *
+ * @return The bitboard having only the given place set
+ */
+inline Bitboard GetPlaceMask(unsigned char place)
+{
+    return 1u << place;
+}
+
+/**
+ * Count the places of a bitboard
+ *
+ * @param[in] board The bitboard
+ *
+ * @return The number of places set
+ */
+inline unsigned char CountPlaces(Bitboard board)
+{
+#if defined(__GNUC__) && defined(__POPCNT__)
+    return __builtin_popcount(board);
+#else
+    // Add the bits in parallel (faster than the library call without the instruction)
+    board -= (board >> 1) & 0x55555555;
+    board = (board & 0x33333333) + ((board >> 2) & 0x33333333);
+    board = (board + (board >> 4)) & 0x0F0F0F0F;
+    return (board * 0x01010101) >> 24;
+#endif
+}
+
+/**
+ * Pop the first place of a bitboard
+ *
+ * @param[in,out] board The bitboard to remove the first place from (must not be empty)
+ *
+ * @return The first place of the bitboard
+ */
+inline unsigned char PopPlace(Bitboard* board)
+{
+#if defined(__GNUC__)
+    unsigned char place = __builtin_ctz(*board);
+#else
+    unsigned char place = 0;
+    while (!(*board & (1u << place)))
+    {
+        ++place;
+    }
+#endif
+    *board &= *board - 1;
+
+    return place;
+}
+
+/**
+ * Select a place of a bitboard
+ *
+ * @param[in] board The bitboard
+ * @param[in] index The index of the place among the places set (must be less than their number)
+ *
+ * @return The place
+ */
+inline unsigned char SelectPlace(Bitboard board, unsigned char index)
+{
+#if defined(__GNUC__) && defined(__BMI2__)
+    return __builtin_ctz(__builtin_ia32_pdep_si(1u << index, board));
+#else
+    for (; index > 0; --index)
+    {
+        board &= board - 1;
+    }
+    return PopPlace(&board);
+#endif
+}
+
+/**
+ * Count the mills of a set
+ *
+ * @param[in] mills The set of the mills
+ *
+ * @return The number of mills
+ */
+inline unsigned char CountMills(MillSet mills)
+{
+    return CountPlaces(mills);
+}
+
+#endif // BITBOARD_H
@@ -0,0 +1,378 @@
+/**
+ * Board Geometry - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef BOARD_GEOMETRY_H
+#define BOARD_GEOMETRY_H
+
+#include <cstddef>
+#include <utility>
+
+#include "Bitboard.hpp"
+#include "GameAction.hpp"
+
+/**
+ * Board geometries of the game variants
+ *
+ * A geometry describes the places, the mills and the adjacency of a
+ * board with constexpr tables, so the rules of BasicGame are generated
+ * for every variant at compile time:
+ * NUM_OF_PLACES - number of places (at most 32)
+ * NUM_OF_PIECES - number of pieces per player
+ * NUM_OF_MILLS - number of mills (at most 32)
+ * NUM_OF_FLYING_PIECES - players with this many pieces or fewer jump anywhere (0 is never)
+ * FULL_BOARD - bitboard of all the places
+ * GetMillMask - places of a mill
+ * GetAdjacentMask - adjacent places of a place
+ */
+
+/** Places of the mills of Three Men's Morris (sides, middle lines and diagonals through the center) */
+constexpr Bitboard THREE_MENS_MORRIS_MILL_MASKS[] =
+{
+    0x007, 0x01C, 0x070, 0x0C1, 0x122, 0x188, 0x111, 0x144
+};
+
+/** Adjacent places of the places of Three Men's Morris (the center is adjacent to every place) */
+constexpr Bitboard THREE_MENS_MORRIS_ADJACENT_MASKS[] =
+{
+    0x182, 0x105, 0x10A, 0x114, 0x128, 0x150, 0x1A0, 0x141, 0x0FF
+};
+
+/** Places of the mills of Six Men's Morris (sides of the squares) */
+constexpr Bitboard SIX_MENS_MORRIS_MILL_MASKS[] =
+{
+    0x0007, 0x001C, 0x0070, 0x00C1, 0x0700, 0x1C00, 0x7000, 0xC100
+};
+
+/** Adjacent places of the places of Six Men's Morris */
+constexpr Bitboard SIX_MENS_MORRIS_ADJACENT_MASKS[] =
+{
+    0x0082, 0x0205, 0x000A, 0x0814, 0x0028, 0x2050, 0x00A0, 0x8041,
+    0x8200, 0x0502, 0x0A00, 0x1408, 0x2800, 0x5020, 0xA000, 0x4180
+};
+
+/**
+ * Places of the mills of Nine Men's Morris
+ *
+ * indexed in the same order as the beginning places of the mills:
+ * 0-11 - sides of the squares (beginning at places 0, 2, 4, 6, 8, ..., 22)
+ * 12-15 - connections of the squares (beginning at places 1, 3, 5, 7)
+ */
+constexpr Bitboard NINE_MENS_MORRIS_MILL_MASKS[] =
+{
+    0x000007, 0x00001C, 0x000070, 0x0000C1,
+    0x000700, 0x001C00, 0x007000, 0x00C100,
+    0x070000, 0x1C0000, 0x700000, 0xC10000,
+    0x020202, 0x080808, 0x202020, 0x808080
+};
+
+/** Adjacent places of the places of Nine Men's Morris */
+constexpr Bitboard NINE_MENS_MORRIS_ADJACENT_MASKS[] =
+{
+    0x000082, 0x000205, 0x00000A, 0x000814, 0x000028, 0x002050, 0x0000A0, 0x008041,
+    0x008200, 0x020502, 0x000A00, 0x081408, 0x002800, 0x205020, 0x00A000, 0x804180,
+    0x820000, 0x050200, 0x0A0000, 0x140800, 0x280000, 0x502000, 0xA00000, 0x418000
+};
+
+/** Places of the mills of Twelve Men's Morris (the ones of Nine Men's Morris and the diagonals) */
+constexpr Bitboard TWELVE_MENS_MORRIS_MILL_MASKS[] =
+{
+    0x000007, 0x00001C, 0x000070, 0x0000C1,
+    0x000700, 0x001C00, 0x007000, 0x00C100,
+    0x070000, 0x1C0000, 0x700000, 0xC10000,
+    0x020202, 0x080808, 0x202020, 0x808080,
+    0x010101, 0x040404, 0x101010, 0x404040
+};
+
+/** Adjacent places of the places of Twelve Men's Morris (the corners are connected by the diagonals) */
+constexpr Bitboard TWELVE_MENS_MORRIS_ADJACENT_MASKS[] =
+{
+    0x000182, 0x000205, 0x00040A, 0x000814, 0x001028, 0x002050, 0x0040A0, 0x008041,
+    0x018201, 0x020502, 0x040A04, 0x081408, 0x102810, 0x205020, 0x40A040, 0x804180,
+    0x820100, 0x050200, 0x0A0400, 0x140800, 0x281000, 0x502000, 0xA04000, 0x418000
+};
+
+/**
+ * Three Men's Morris
+ *
+ * A square and its center (8), indexed like the outer square of
+ * Nine Men's Morris. Every line is a mill, so the first mill after the
+ * placing decides the game, nobody jumps.
+ */
+struct ThreeMensMorris
+{
+    static constexpr unsigned char NUM_OF_PLACES = 9;
+    static constexpr unsigned char NUM_OF_PIECES = 3;
+    static constexpr unsigned char NUM_OF_MILLS = 8;
+    static constexpr unsigned char NUM_OF_FLYING_PIECES = 0;
+    static constexpr Bitboard FULL_BOARD = (1u << NUM_OF_PLACES) - 1;
+
+    static constexpr Bitboard GetMillMask(unsigned char mill)
+    {
+        return THREE_MENS_MORRIS_MILL_MASKS[mill];
+    }
+
+    static constexpr Bitboard GetAdjacentMask(unsigned char place)
+    {
+        return THREE_MENS_MORRIS_ADJACENT_MASKS[place];
+    }
+};
+
+/**
+ * Six Men's Morris
+ *
+ * Two squares indexed like the outer ones of Nine Men's Morris,
+ * connected in the middle of the sides, nobody jumps.
+ */
+struct SixMensMorris
+{
+    static constexpr unsigned char NUM_OF_PLACES = 16;
+    static constexpr unsigned char NUM_OF_PIECES = 6;
+    static constexpr unsigned char NUM_OF_MILLS = 8;
+    static constexpr unsigned char NUM_OF_FLYING_PIECES = 0;
+    static constexpr Bitboard FULL_BOARD = (1u << NUM_OF_PLACES) - 1;
+
+    static constexpr Bitboard GetMillMask(unsigned char mill)
+    {
+        return SIX_MENS_MORRIS_MILL_MASKS[mill];
+    }
+
+    static constexpr Bitboard GetAdjacentMask(unsigned char place)
+    {
+        return SIX_MENS_MORRIS_ADJACENT_MASKS[place];
+    }
+};
+
+/**
+ * Nine Men's Morris
+ *
+ * Three squares indexed from the outer one, see the field of BasicGame.
+ * The default geometry of Game, the search, the tablebase and the
+ * batched games are implemented for it.
+ */
+struct NineMensMorris
+{
+    static constexpr unsigned char NUM_OF_PLACES = NUM_OF_FIELD_PLACES;
+    static constexpr unsigned char NUM_OF_PIECES = ::NUM_OF_PIECES;
+    static constexpr unsigned char NUM_OF_MILLS = ::NUM_OF_MILLS;
+    static constexpr unsigned char NUM_OF_FLYING_PIECES = 3;
+    static constexpr Bitboard FULL_BOARD = ::FULL_BOARD;
+
+    static constexpr Bitboard GetMillMask(unsigned char mill)
+    {
+        return NINE_MENS_MORRIS_MILL_MASKS[mill];
+    }
+
+    static constexpr Bitboard GetAdjacentMask(unsigned char place)
+    {
+        return NINE_MENS_MORRIS_ADJACENT_MASKS[place];
+    }
+};
+
+/**
+ * Twelve Men's Morris
+ *
+ * The board of Nine Men's Morris with the corners of the squares
+ * connected by diagonals, which are mills too.
+ */
+struct TwelveMensMorris
+{
+    static constexpr unsigned char NUM_OF_PLACES = NUM_OF_FIELD_PLACES;
+    static constexpr unsigned char NUM_OF_PIECES = 12;
+    static constexpr unsigned char NUM_OF_MILLS = 20;
+    static constexpr unsigned char NUM_OF_FLYING_PIECES = 3;
+    static constexpr Bitboard FULL_BOARD = ::FULL_BOARD;
+
+    static constexpr Bitboard GetMillMask(unsigned char mill)
+    {
+        return TWELVE_MENS_MORRIS_MILL_MASKS[mill];
+    }
+
+    static constexpr Bitboard GetAdjacentMask(unsigned char place)
+    {
+        return TWELVE_MENS_MORRIS_ADJACENT_MASKS[place];
+    }
+};
+
+/**
+ * Find the mills of a bitboard in a geometry (expanded for every mill)
+ *
+ * @param[in] board The bitboard of the pieces of a player
+ *
+ * @return The set of the mills formed by the pieces
+ */
+template <typename Geometry, std::size_t... Mills>
+inline MillSet FindMills(Bitboard board, std::index_sequence<Mills...>)
+{
+    MillSet mills = 0;
+    using Expansion = int[];
+    (void)Expansion
+    {
+        0, (mills |= static_cast<MillSet>((board & Geometry::GetMillMask(Mills)) == Geometry::GetMillMask(Mills))
+                     << Mills, 0)...
+    };
+
+    return mills;
+}
+
+/**
+ * Find the mills of a bitboard in a geometry
+ *
+ * The check of every mill is generated at compile time with the mask
+ * as a constant, without loops and branches.
+ *
+ * @param[in] board The bitboard of the pieces of a player
+ *
+ * @return The set of the mills formed by the pieces
+ */
+template <typename Geometry>
+inline MillSet FindMills(Bitboard board)
+{
+    return FindMills<Geometry>(board, std::make_index_sequence<Geometry::NUM_OF_MILLS>());
+}
+
+/**
+ * Get the places of mills in a geometry (expanded for every mill)
+ *
+ * @param[in] mills The set of the mills
+ *
+ * @return The bitboard of the places included in the mills
+ */
+template <typename Geometry, std::size_t... Mills>
+inline Bitboard GetMillPlaces(MillSet mills, std::index_sequence<Mills...>)
+{
+    Bitboard places = 0;
+    using Expansion = int[];
+    (void)Expansion
+    {
+        0, (places |= Geometry::GetMillMask(Mills) & (0u - ((mills >> Mills) & 1u)), 0)...
+    };
+
+    return places;
+}
+
+/**
+ * Get the places of mills in a geometry
+ *
+ * @param[in] mills The set of the mills
+ *
+ * @return The bitboard of the places included in the mills
+ */
+template <typename Geometry>
+inline Bitboard GetMillPlaces(MillSet mills)
+{
+    return GetMillPlaces<Geometry>(mills, std::make_index_sequence<Geometry::NUM_OF_MILLS>());
+}
+
+/**
+ * Mills of the places of a geometry
+ */
+template <typename Geometry>
+struct PlaceMillTable
+{
+    /** Set of the mills including the place */
+    MillSet mills[Geometry::NUM_OF_PLACES];
+};
+
+/**
+ * Create the mills of the places of a geometry
+ *
+ * @return The table of the mills of the places
+ */
+template <typename Geometry>
+constexpr PlaceMillTable<Geometry> CreatePlaceMillTable()
+{
+    PlaceMillTable<Geometry> table = {};
+    for (unsigned char mill = 0; mill < Geometry::NUM_OF_MILLS; ++mill)
+    {
+        for (unsigned char place = 0; place < Geometry::NUM_OF_PLACES; ++place)
+        {
+            if (Geometry::GetMillMask(mill) & (1u << place))
+            {
+                table.mills[place] |= 1u << mill;
+            }
+        }
+    }
+
+    return table;
+}
+
+/** Mills of the places of a geometry (generated at compile time) */
+template <typename Geometry>
+constexpr PlaceMillTable<Geometry> PLACE_MILL_TABLE = CreatePlaceMillTable<Geometry>();
+
+/**
+ * Get the mills including a place in a geometry
+ *
+ * @param[in] place The place
+ *
+ * @return The set of the mills including the place
+ */
+template <typename Geometry>
+inline MillSet GetPlaceMills(unsigned char place)
+{
+    return PLACE_MILL_TABLE<Geometry>.mills[place];
+}
+
+/**
+ * Get the maximum number of mills formed by an action in a geometry
+ *
+ * An action fills a single place, so the new mills all include it.
+ *
+ * @return The most mills including the same place
+ */
+template <typename Geometry>
+constexpr unsigned char GetMaxNumberOfActionMills()
+{
+    unsigned char maxNumOfMills = 0;
+    for (unsigned char place = 0; place < Geometry::NUM_OF_PLACES; ++place)
+    {
+        unsigned char numOfMills = 0;
+        for (MillSet mills = PLACE_MILL_TABLE<Geometry>.mills[place]; mills != 0; mills &= mills - 1)
+        {
+            ++numOfMills;
+        }
+        if (maxNumOfMills < numOfMills)
+        {
+            maxNumOfMills = numOfMills;
+        }
+    }
+
+    return maxNumOfMills;
+}
+
+/**
+ * Get the maximum number of actions of a player in a geometry
+ *
+ * The most of placing anywhere, jumping and moving along every
+ * connection of the board.
+ *
+ * @return The maximum number of actions
+ */
+template <typename Geometry>
+constexpr unsigned int GetMaxNumberOfActions()
+{
+    unsigned int numOfConnections = 0;
+    for (unsigned char place = 0; place < Geometry::NUM_OF_PLACES; ++place)
+    {
+        for (Bitboard adjacentPlaces = Geometry::GetAdjacentMask(place); adjacentPlaces != 0;
+                adjacentPlaces &= adjacentPlaces - 1)
+        {
+            ++numOfConnections;
+        }
+    }
+    numOfConnections /= 2;
+
+    unsigned int numOfJumps = Geometry::NUM_OF_FLYING_PIECES * (Geometry::NUM_OF_PLACES - Geometry::NUM_OF_FLYING_PIECES);
+    unsigned int maxNumOfActions = Geometry::NUM_OF_PLACES;
+    maxNumOfActions = numOfConnections > maxNumOfActions ? numOfConnections : maxNumOfActions;
+    return numOfJumps > maxNumOfActions ? numOfJumps : maxNumOfActions;
+}
+
+#endif // BOARD_GEOMETRY_H
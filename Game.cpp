@@ -10,63 +10,246 @@
 
 #include "Game.hpp"
 
-#include <algorithm>
-#include <cstdlib>
-#include <ctime>
 #include <fstream>
 
 // TODO: REWORK LOGGING
 // #include "../eMorrisGUI/_Source/engine/UtilityFunctions.hpp"
 
 // TODO: REMOVE
-std::array<unsigned char, NUM_OF_FIELD_PLACES>* Game::GetField()
+template <typename Geometry>
+std::array<unsigned char, Geometry::NUM_OF_PLACES>* BasicGame<Geometry>::GetField()
 {
     return &field;
 }
 
-Game::Game()
+template <typename Geometry>
+BasicGame<Geometry>::BasicGame() : BasicGame(&Random::GetThreadRandom())
+{
+}
+
+template <typename Geometry>
+BasicGame<Geometry>::BasicGame(Random* random)
 {
     // Initialize
     for (unsigned char index = 0; index < NUM_OF_PLAYERS; index++)
     {
-        deck[index] = NUM_OF_PIECES;
+        deck[index] = Geometry::NUM_OF_PIECES;
         numOfPieces[index] = 0;
     }
 
     // Select starting player
-    srand(time(nullptr));
-    currentPlayer = rand() % NUM_OF_PLAYERS;
+    currentPlayer = random->Next(NUM_OF_PLAYERS);
 
     // Setting game state
     state = GameState::Place;
+
+    hash = ComputeHash();
 }
 
-GameState Game::GetGameState()
+template <typename Geometry>
+BasicGame<Geometry>::BasicGame(const GamePosition& position)
 {
-    return state;
+    if (SetPosition(position))
+    {
+        return;
+    }
+
+    // Start the game with the first player instead of the invalid position
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; index++)
+    {
+        deck[index] = Geometry::NUM_OF_PIECES;
+        numOfPieces[index] = 0;
+    }
+    currentPlayer = 0;
+    state = GameState::Place;
+
+    hash = ComputeHash();
 }
 
-inline unsigned char Game::GetCurrentPlayer()
+template <typename Geometry>
+GamePosition BasicGame<Geometry>::GetPosition()
 {
-    return currentPlayer + 1;
+    GamePosition position;
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+    {
+        position.pieces[index] = pieces[index];
+        position.mills[index] = mills[index];
+        position.deck[index] = deck[index];
+        position.numOfPieces[index] = numOfPieces[index];
+    }
+    position.state = state;
+    position.currentPlayer = GetCurrentPlayer();
+    position.numOfMills = numOfMills;
+
+    return position;
 }
 
-unsigned char Game::GetDeck()
+template <typename Geometry>
+bool BasicGame<Geometry>::IsValidPosition(const GamePosition& position)
+{
+    // Only the removals of the mills formed by the last action can be pending
+    unsigned char maxNumOfMills = position.state == GameState::Remove ? GetMaxNumberOfActionMills<Geometry>() : 0;
+    if (position.state < GameState::Place || position.state > GameState::End || position.currentPlayer < 1
+            || position.currentPlayer > NUM_OF_PLAYERS || position.numOfMills > maxNumOfMills
+            || (position.state == GameState::Remove && position.numOfMills == 0)
+            || (position.pieces[0] & position.pieces[1]) != 0)
+    {
+        return false;
+    }
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+    {
+        if ((position.pieces[index] & ~Geometry::FULL_BOARD) != 0
+                || CountPlaces(position.pieces[index]) != position.numOfPieces[index]
+                || position.deck[index] + position.numOfPieces[index] > Geometry::NUM_OF_PIECES
+                || (position.mills[index] & ~FindMills<Geometry>(position.pieces[index])) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename Geometry>
+bool BasicGame<Geometry>::SetPosition(const GamePosition& position)
+{
+    if (!IsValidPosition(position))
+    {
+        return false;
+    }
+
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+    {
+        pieces[index] = position.pieces[index];
+        mills[index] = position.mills[index];
+        deck[index] = position.deck[index];
+        numOfPieces[index] = position.numOfPieces[index];
+    }
+    state = static_cast<GameState>(position.state);
+    currentPlayer = position.currentPlayer - 1;
+    numOfMills = position.numOfMills;
+
+    // Derive the field and the hash from the pieces
+    for (unsigned char place = 0; place < Geometry::NUM_OF_PLACES; ++place)
+    {
+        field[place] = pieces[0] & GetPlaceMask(place) ? 1 : pieces[1] & GetPlaceMask(place) ? 2 : EMPTY_PLACE;
+    }
+    hash = ComputeHash();
+
+    return true;
+}
+
+template <typename Geometry>
+constexpr const GameHashKeys<Geometry>& BasicGame<Geometry>::hashKeys;
+
+template <typename Geometry>
+thread_local GameStatistics BasicGame<Geometry>::statistics;
+
+template <typename Geometry>
+GameState BasicGame<Geometry>::GetGameState()
+{
+    return state;
+}
+
+template <typename Geometry>
+unsigned char BasicGame<Geometry>::GetDeck()
 {
     return deck[currentPlayer];
 }
 
-unsigned char Game::GetNumberOfPieces()
+template <typename Geometry>
+unsigned char BasicGame<Geometry>::GetDeck(unsigned char player)
+{
+    return deck[player - 1];
+}
+
+template <typename Geometry>
+unsigned char BasicGame<Geometry>::GetNumberOfPieces()
 {
     return numOfPieces[currentPlayer];
 }
 
-unsigned char Game::GetNumberOfMills()
+template <typename Geometry>
+unsigned char BasicGame<Geometry>::GetNumberOfPieces(unsigned char player)
+{
+    return numOfPieces[player - 1];
+}
+
+template <typename Geometry>
+Bitboard BasicGame<Geometry>::GetPieces(unsigned char player)
+{
+    return pieces[player - 1];
+}
+
+template <typename Geometry>
+unsigned char BasicGame<Geometry>::GetNumberOfMills()
 {
     return numOfMills;
 }
 
-void Game::CheckState()
+template <typename Geometry>
+unsigned long long BasicGame<Geometry>::GetHash()
+{
+    return hash;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::GetActions(GameActionList* actions)
+{
+    actions->size = 0;
+
+    Bitboard emptyPlaces = Geometry::FULL_BOARD & ~(pieces[0] | pieces[1]);
+    switch (state)
+    {
+    case GameState::Place:
+        // Place to any empty place
+        while (emptyPlaces != 0)
+        {
+            actions->actions[actions->size++] = { NO_PLACE, PopPlace(&emptyPlaces) };
+        }
+        break;
+
+    case GameState::Move:
+    {
+        // Move to adjacent empty places or jump to any empty place with few enough pieces
+        Bitboard playerPieces = pieces[currentPlayer];
+        while (playerPieces != 0)
+        {
+            unsigned char fromPlace = PopPlace(&playerPieces);
+            Bitboard toPlaces = emptyPlaces;
+            if (numOfPieces[currentPlayer] > Geometry::NUM_OF_FLYING_PIECES)
+            {
+                toPlaces &= Geometry::GetAdjacentMask(fromPlace);
+            }
+
+            while (toPlaces != 0)
+            {
+                actions->actions[actions->size++] = { fromPlace, PopPlace(&toPlaces) };
+            }
+        }
+        break;
+    }
+
+    case GameState::Remove:
+    {
+        // Remove pieces not in mills or any piece if all of them are in mills
+        Bitboard opponentPieces = pieces[GetOpponentIndex()];
+        Bitboard millPlaces = GetMillPlaces<Geometry>(FindMills<Geometry>(opponentPieces));
+        Bitboard removablePieces = millPlaces == opponentPieces ? opponentPieces : opponentPieces & ~millPlaces;
+        while (removablePieces != 0)
+        {
+            actions->actions[actions->size++] = { PopPlace(&removablePieces), NO_PLACE };
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::CheckState()
 {
     switch (state)
     {
@@ -80,8 +263,11 @@ void Game::CheckState()
         // Set game state to end if the opponent has not enough pieces
         if (numOfPieces[currentPlayer] < 3 && deck[currentPlayer] == 0)
         {
-            state = GameState::End;
+            SetState(GameState::End);
             NextPlayer();
+
+            // Forget the mills broken by the last move (the mills are not checked any more)
+            mills[currentPlayer] &= FindMills<Geometry>(pieces[currentPlayer]);
             break;
         }
         NextPlayer();
@@ -89,7 +275,7 @@ void Game::CheckState()
         // Set game state to remove if the current player has a mill
         if (CheckForMills())
         {
-            state = GameState::Remove;
+            SetState(GameState::Remove);
             break;
         }
         NextPlayer();
@@ -100,12 +286,12 @@ void Game::CheckState()
             // Set game state to end if the opponent can't move
             if (!CheckHasMove())
             {
-                state = GameState::End;
+                SetState(GameState::End);
                 NextPlayer();
                 break;
             }
 
-            state = GameState::Move;
+            SetState(GameState::Move);
             break;
         }
 
@@ -113,17 +299,19 @@ void Game::CheckState()
 
     case GameState::Remove:
         NextPlayer();
-        // Set game state to end if the opponent has not enough pieces
+        // Set game state to end if the opponent has not enough pieces (no removals are pending any more)
         if (numOfPieces[currentPlayer] < 3 && deck[currentPlayer] == 0)
         {
-            state = GameState::End;
+            SetState(GameState::End);
             NextPlayer();
+            SetNumberOfMills(0);
             break;
         }
         NextPlayer();
 
         // Stay in this state if the current player still has mills
-        if (--numOfMills > 0)
+        SetNumberOfMills(numOfMills - 1);
+        if (numOfMills > 0)
         {
             break;
         }
@@ -133,20 +321,20 @@ void Game::CheckState()
         if (deck[currentPlayer] > 0)
         {
             CheckForMills();
-            state = GameState::Place;
+            SetState(GameState::Place);
             break;
         }
 
         // Set game state to end if the opponent can't move
         if (!CheckHasMove())
         {
-            state = GameState::End;
+            SetState(GameState::End);
             NextPlayer();
             break;
         }
 
         // Set game state to move if the piece was removed
-        state = GameState::Move;
+        SetState(GameState::Move);
         break;
 
     case GameState::End:
@@ -154,29 +342,33 @@ void Game::CheckState()
     }
 }
 
-bool Game::Place(unsigned char point)
+template <typename Geometry>
+bool BasicGame<Geometry>::Place(unsigned char point)
 {
     if (state != GameState::Place || !CheckPlace(point))
     {
+        STATISTICS_COUNT(statistics.numOfRejectedPlaces);
         return false;
     }
 
     // Set field point to current player's index
-    field[point] = GetCurrentPlayer();
+    SetPlace(point, GetCurrentPlayer());
 
-    deck[currentPlayer]--;
+    SetDeck(currentPlayer, deck[currentPlayer] - 1);
     numOfPieces[currentPlayer]++;
 
     return true;
 }
 
-bool Game::Move(unsigned char fromPoint, unsigned char toPoint)
+template <typename Geometry>
+bool BasicGame<Geometry>::Move(unsigned char fromPoint, unsigned char toPoint)
 {
     // Check first part of the move
-    if (toPoint == 255)
+    if (toPoint == NO_PLACE)
     {
         if (state != GameState::Move || !CheckRemove(fromPoint, true))
         {
+            STATISTICS_COUNT(statistics.numOfRejectedMoves);
             return false;
         }
     }
@@ -185,75 +377,252 @@ bool Game::Move(unsigned char fromPoint, unsigned char toPoint)
     {
         if (state != GameState::Move || !CheckMove(fromPoint, toPoint))
         {
+            STATISTICS_COUNT(statistics.numOfRejectedMoves);
             return false;
         }
 
         // Set field point "to" to current player and field point "from" to empty
-        field[toPoint] = field[fromPoint];
-        field[fromPoint] = EMPTY_PLACE;
+        SetPlace(toPoint, field[fromPoint]);
+        SetPlace(fromPoint, EMPTY_PLACE);
     }
 
     return true;
 }
 
-bool Game::Remove(unsigned char point)
+template <typename Geometry>
+bool BasicGame<Geometry>::Remove(unsigned char point)
 {
     if (state != GameState::Remove || !CheckRemove(point))
     {
+        STATISTICS_COUNT(statistics.numOfRejectedRemoves);
         return false;
     }
 
     // Set field point to empty
-    field[point] = EMPTY_PLACE;
+    SetPlace(point, EMPTY_PLACE);
 
+    // Forget the broken mill of the opponent, forming it again is a new mill
     NextPlayer();
     numOfPieces[currentPlayer]--;
+    mills[currentPlayer] &= FindMills<Geometry>(pieces[currentPlayer]);
     NextPlayer();
 
     return true;
 }
 
-void Game::NextPlayer()
+template <typename Geometry>
+bool BasicGame<Geometry>::Apply(GameAction action, GameUndo* undo)
+{
+    GameUndo record = { action, state, currentPlayer, numOfMills, { mills[0], mills[1] }, hash };
+
+    bool applied = false;
+    switch (state)
+    {
+    case GameState::Place:
+        applied = Place(action.to);
+        break;
+
+    case GameState::Move:
+        // The first part of a move is not an action
+        if (action.to == NO_PLACE)
+        {
+            STATISTICS_COUNT(statistics.numOfRejectedMoves);
+            break;
+        }
+        applied = Move(action.from, action.to);
+        break;
+
+    case GameState::Remove:
+        applied = Remove(action.from);
+        break;
+
+    default:
+        break;
+    }
+
+    if (!applied)
+    {
+        return false;
+    }
+
+    CheckState();
+
+    if (undo != nullptr)
+    {
+        *undo = record;
+    }
+
+    return true;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::Undo(const GameUndo& undo)
+{
+    state = undo.state;
+    currentPlayer = undo.currentPlayer;
+    numOfMills = undo.numOfMills;
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+    {
+        mills[index] = undo.mills[index];
+    }
+
+    switch (undo.state)
+    {
+    case GameState::Place:
+        SetPlace(undo.action.to, EMPTY_PLACE);
+        deck[currentPlayer]++;
+        numOfPieces[currentPlayer]--;
+        break;
+
+    case GameState::Move:
+        SetPlace(undo.action.from, GetCurrentPlayer());
+        SetPlace(undo.action.to, EMPTY_PLACE);
+        break;
+
+    case GameState::Remove:
+        SetPlace(undo.action.from, GetOpponentIndex() + 1);
+        numOfPieces[GetOpponentIndex()]++;
+        break;
+
+    default:
+        break;
+    }
+
+    hash = undo.hash;
+}
+
+template <typename Geometry>
+GameStatistics BasicGame<Geometry>::GetStatistics()
+{
+    return statistics;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::ResetStatistics()
+{
+    statistics = GameStatistics();
+}
+
+template <typename Geometry>
+unsigned char BasicGame<Geometry>::GetOpponentIndex()
+{
+    return (currentPlayer + 1) % NUM_OF_PLAYERS;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::SetPlace(unsigned char place, unsigned char value)
+{
+    Bitboard placeMask = GetPlaceMask(place);
+
+    // Update the hash of the pieces
+    if (field[place] != EMPTY_PLACE)
+    {
+        hash ^= hashKeys.pieces[field[place] - 1][place];
+    }
+    if (value != EMPTY_PLACE)
+    {
+        hash ^= hashKeys.pieces[value - 1][place];
+    }
+
+    // Clear the place from the pieces of the players
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+    {
+        pieces[index] &= ~placeMask;
+    }
+
+    // Set the place for the player
+    if (value != EMPTY_PLACE)
+    {
+        pieces[value - 1] |= placeMask;
+    }
+
+    field[place] = value;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::SetState(GameState state)
+{
+    hash ^= hashKeys.states[this->state] ^ hashKeys.states[state];
+    this->state = state;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::SetDeck(unsigned char player, unsigned char value)
+{
+    hash ^= hashKeys.decks[player][deck[player]] ^ hashKeys.decks[player][value];
+    deck[player] = value;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::SetNumberOfMills(unsigned char value)
+{
+    hash ^= hashKeys.mills[numOfMills] ^ hashKeys.mills[value];
+    numOfMills = value;
+}
+
+template <typename Geometry>
+void BasicGame<Geometry>::NextPlayer()
 {
     // Set the next player as the current player
+    hash ^= hashKeys.players[currentPlayer];
     currentPlayer++;
     if (currentPlayer >= NUM_OF_PLAYERS)
     {
         currentPlayer = 0;
     }
+    hash ^= hashKeys.players[currentPlayer];
 }
 
-bool Game::CheckHasMove()
+template <typename Geometry>
+unsigned long long BasicGame<Geometry>::ComputeHash()
 {
-    if (numOfPieces[currentPlayer] <= 3)
+    unsigned long long hash = hashKeys.states[state] ^ hashKeys.players[currentPlayer] ^ hashKeys.mills[numOfMills];
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
     {
-        return true;
-    }
+        hash ^= hashKeys.decks[index][deck[index]];
 
-    for (unsigned char place = 0; place < NUM_OF_FIELD_PLACES; ++place)
-    {
-        if (field[place] != GetCurrentPlayer())
+        Bitboard playerPieces = pieces[index];
+        while (playerPieces != 0)
         {
-            continue;
+            hash ^= hashKeys.pieces[index][PopPlace(&playerPieces)];
         }
+    }
+
+    return hash;
+}
+
+template <typename Geometry>
+bool BasicGame<Geometry>::CheckHasMove()
+{
+    if (numOfPieces[currentPlayer] <= Geometry::NUM_OF_FLYING_PIECES)
+    {
+        return true;
+    }
 
-        std::vector<unsigned char>::const_iterator api;
-        for (api = adjacentPlaces[place].cbegin(); api != adjacentPlaces[place].cend(); ++api)
+    Bitboard emptyPlaces = Geometry::FULL_BOARD & ~(pieces[0] | pieces[1]);
+    Bitboard playerPieces = pieces[currentPlayer];
+    while (playerPieces != 0)
+    {
+        if (Geometry::GetAdjacentMask(PopPlace(&playerPieces)) & emptyPlaces)
         {
-            if (field[*api] == EMPTY_PLACE)
-            {
-                return true;
-            }
+            return true;
         }
     }
 
     return false;
 }
 
-bool Game::CheckPlace(unsigned char point)
+template <typename Geometry>
+bool BasicGame<Geometry>::CheckPlace(unsigned char point)
 {
+    // Check if point is on the field
+    if (point >= Geometry::NUM_OF_PLACES)
+    {
+        return false;
+    }
+
     // Check if point is empty
-    if (field[point] != 0)
+    if ((pieces[0] | pieces[1]) & GetPlaceMask(point))
     {
         return false;
     }
@@ -261,8 +630,15 @@ bool Game::CheckPlace(unsigned char point)
     return true;
 }
 
-bool Game::CheckMove(unsigned char fromPoint, unsigned char toPoint)
+template <typename Geometry>
+bool BasicGame<Geometry>::CheckMove(unsigned char fromPoint, unsigned char toPoint)
 {
+    // Check if points are on the field
+    if (fromPoint >= Geometry::NUM_OF_PLACES || toPoint >= Geometry::NUM_OF_PLACES)
+    {
+        return false;
+    }
+
     // Check if from point is the same as to point
     if (fromPoint == toPoint)
     {
@@ -281,131 +657,67 @@ bool Game::CheckMove(unsigned char fromPoint, unsigned char toPoint)
         return false;
     }
 
-    // Check move if the player can not jump
-    if (numOfPieces[currentPlayer] > 3)
+    // Check if player moves to the adjacent point if the player can not jump
+    if (numOfPieces[currentPlayer] > Geometry::NUM_OF_FLYING_PIECES
+            && !(Geometry::GetAdjacentMask(fromPoint) & GetPlaceMask(toPoint)))
     {
-        // Check if player moves to the adjacent point (and does not jump to next square starting point)
-        if ((toPoint != fromPoint - 1 && toPoint != fromPoint + 1) || (fromPoint % NUM_OF_SQUARE_PLACES == 0
-                && toPoint == fromPoint - 1) || (fromPoint % NUM_OF_SQUARE_PLACES == NUM_OF_SQUARE_PLACES - 1
-                        && toPoint == fromPoint + 1))
-        {
-            // Check if player moves where the square is closing (abs(from-to)==7)
-            if ((fromPoint % NUM_OF_SQUARE_PLACES != 0 || toPoint != fromPoint + NUM_OF_SQUARE_PLACES - 1)
-                    && (fromPoint % NUM_OF_SQUARE_PLACES != NUM_OF_SQUARE_PLACES - 1 || toPoint != fromPoint - NUM_OF_SQUARE_PLACES + 1))
-            {
-                // Check if player moves to another square
-                if (fromPoint % 2 != 1 || (toPoint != fromPoint - NUM_OF_SQUARE_PLACES && toPoint != fromPoint + NUM_OF_SQUARE_PLACES))
-                {
-                    return false;
-                }
-            }
-        }
+        return false;
     }
 
     return true;
 }
 
-bool Game::CheckRemove(unsigned char place, bool currentPlayerCheck)
+template <typename Geometry>
+bool BasicGame<Geometry>::CheckRemove(unsigned char place, bool currentPlayerCheck)
 {
+    // Check if place is on the field
+    if (place >= Geometry::NUM_OF_PLACES)
+    {
+        return false;
+    }
+
+    Bitboard placeMask = GetPlaceMask(place);
+
     // Check if place is empty
-    if (field[place] == 0)
+    if (!((pieces[0] | pieces[1]) & placeMask))
     {
         return false;
     }
     // Check if place has the current player's piece
-    else if (currentPlayerCheck && field[place] != GetCurrentPlayer())
+    else if (currentPlayerCheck && !(pieces[currentPlayer] & placeMask))
     {
         return false;
     }
     // Check if place has the opponent's piece
     else if (!currentPlayerCheck)
     {
-        if (field[place] == GetCurrentPlayer())
+        if (pieces[currentPlayer] & placeMask)
         {
             return false;
         }
 
         // Check if piece is included in a mill and has other pieces that are not
-        std::array<bool, NUM_OF_FIELD_PLACES> isMills = { false };
-        NextPlayer(); // TODO: replace with more elegant solution
-        CheckForMills(&isMills);
-
-        if (isMills[place])
+        Bitboard opponentPieces = pieces[GetOpponentIndex()];
+        Bitboard millPlaces = GetMillPlaces<Geometry>(FindMills<Geometry>(opponentPieces));
+        if ((millPlaces & placeMask) && millPlaces != opponentPieces)
         {
-            unsigned char count = 0;
-            for (unsigned char index = 0; index < NUM_OF_FIELD_PLACES; ++index)
-            {
-                if (isMills[index])
-                {
-                    ++count;
-                }
-            }
-            if (count != numOfPieces[currentPlayer])
-            {
-                NextPlayer(); // TODO: replace with more elegant solution
-                return false;
-            }
+            return false;
         }
-        NextPlayer(); // TODO: replace with more elegant solution
     }
 
     return true;
 }
 
-bool Game::CheckForMills(std::array<bool, NUM_OF_FIELD_PLACES>* isMills)
+template <typename Geometry>
+bool BasicGame<Geometry>::CheckForMills()
 {
-    std::vector<unsigned char> mills;
-
-    // Loop through the squares
-    for (unsigned char square = 0; square < NUM_OF_SQUARES; ++square)
-    {
-        // Loop through the sides of a square
-        for (unsigned char place = square * NUM_OF_SQUARE_PLACES;
-                place < (square + 1) * NUM_OF_SQUARE_PLACES; place += NUM_OF_PLACES_TO_SHIFT)
-        {
-            if (CheckMill(place, isMills))
-            {
-                mills.push_back(place);
-            }
-        }
-    }
-
-    // Loop through the connections of the squares
-    for (unsigned char place = 1; place < NUM_OF_SQUARE_PLACES; place += NUM_OF_PLACES_TO_SHIFT)
-    {
-        if (CheckMill(place, isMills))
-        {
-            mills.push_back(place);
-        }
-    }
-
-    // Don't update
-    if (isMills != nullptr)
-    {
-        return false;
-    }
+    MillSet currentMills = FindMills<Geometry>(pieces[currentPlayer]);
 
     // Looking for new mills
-    numOfMills = 0;
-    for (std::vector<unsigned char>::iterator it = mills.begin(); it != mills.end();
-            ++it)
-    {
-        std::vector<unsigned char>::iterator itFind = std::find(
-                    this->mills[currentPlayer].begin(), this->mills[currentPlayer].end(), *it);
-
-        if (itFind == this->mills[currentPlayer].end())
-        {
-            numOfMills++;
-        }
-    }
+    SetNumberOfMills(CountMills(currentMills & ~mills[currentPlayer]));
 
     // Replace stored mills with the current ones
-    this->mills[currentPlayer].clear();
-    this->mills[currentPlayer].reserve(mills.size());
-    for (std::vector<unsigned char>::iterator it = mills.begin(); it != mills.end(); ++it)
-    {
-        this->mills[currentPlayer].push_back(*it);
-    }
+    mills[currentPlayer] = currentMills;
 
     // Return true if the current player has a mill
     if (numOfMills > 0)
@@ -416,41 +728,7 @@ bool Game::CheckForMills(std::array<bool, NUM_OF_FIELD_PLACES>* isMills)
     return false;
 }
 
-bool Game::CheckMill(unsigned char place, std::array<bool, NUM_OF_FIELD_PLACES>* isMills)
-{
-    std::array<unsigned char,  NUM_OF_PLACES_TO_SHIFT + 1> places = GetMillPlaces(place);
-    if (field[places[0]] == GetCurrentPlayer() && field[places[1]] == field[places[0]]
-            && field[places[2]] == field[places[0]])
-    {
-        if (isMills != nullptr)
-        {
-            isMills->at(places[0]) = true;
-            isMills->at(places[1]) = true;
-            isMills->at(places[2]) = true;
-        }
-        return true;
-    }
-
-    return false;
-}
-
-std::array<unsigned char, NUM_OF_PLACES_TO_SHIFT + 1> Game::GetMillPlaces(unsigned char place)
-{
-    std::array<unsigned char,  NUM_OF_PLACES_TO_SHIFT + 1> places;
-
-    // Get mill places on the connection of the squares
-    if (place % 2 == 1 && place < NUM_OF_SQUARE_PLACES)
-    {
-        places = { place, place + NUM_OF_SQUARE_PLACES, place + NUM_OF_SQUARE_PLACES * 2 };
-    }
-
-    // Get mill places on the side of a square
-    if (place % 2 == 0 && place < NUM_OF_FIELD_PLACES)
-    {
-        unsigned char placePlusTwo = (place + 2) % NUM_OF_SQUARE_PLACES == 0 ? (place / NUM_OF_SQUARE_PLACES) *
-                                     NUM_OF_SQUARE_PLACES : place + 2;
-        places = { place, place + 1, placePlusTwo };
-    }
-
-    return places;
-}
+template class BasicGame<ThreeMensMorris>;
+template class BasicGame<SixMensMorris>;
+template class BasicGame<NineMensMorris>;
+template class BasicGame<TwelveMensMorris>;
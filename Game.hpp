@@ -12,18 +12,122 @@
 #define GAME_H
 
 #include <array>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "Bitboard.hpp"
+#include "BoardGeometry.hpp"
+#include "GameAction.hpp"
 #include "GameConstants.hpp"
+#include "GamePosition.hpp"
 #include "GameState.hpp"
+#include "GameUndo.hpp"
+#include "Random.hpp"
+#include "Statistics.hpp"
 
-class Game
+/**
+ * Random keys of the position hash of a geometry
+ */
+template <typename Geometry>
+struct GameHashKeys
+{
+    /** Keys of the pieces of the players on the field places */
+    unsigned long long pieces[NUM_OF_PLAYERS][Geometry::NUM_OF_PLACES];
+
+    /** Keys of the current player */
+    unsigned long long players[NUM_OF_PLAYERS];
+
+    /** Keys of the game states */
+    unsigned long long states[NUM_OF_GAME_STATES];
+
+    /** Keys of the number of pieces in the decks of the players */
+    unsigned long long decks[NUM_OF_PLAYERS][Geometry::NUM_OF_PIECES + 1];
+
+    /** Keys of the number of mills of the current player */
+    unsigned long long mills[Geometry::NUM_OF_MILLS + 1];
+};
+
+/**
+ * Generate the next random key of the position hash
+ *
+ * The keys are generated by the SplitMix64 generator, always the same keys.
+ *
+ * @param[in,out] seed Pointer to the state of the generator
+ *
+ * @return The key
+ */
+constexpr unsigned long long GenerateHashKey(unsigned long long* seed)
+{
+    unsigned long long value = (*seed += 0x9E3779B97F4A7C15ull);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/**
+ * Create the random keys of the position hash of a geometry
+ *
+ * @return The keys (generated in the order of the members)
+ */
+template <typename Geometry>
+constexpr GameHashKeys<Geometry> CreateGameHashKeys()
+{
+    GameHashKeys<Geometry> keys = {};
+    unsigned long long seed = 0x4D6F727269734B65ull;
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        for (unsigned char place = 0; place < Geometry::NUM_OF_PLACES; ++place)
+        {
+            keys.pieces[player][place] = GenerateHashKey(&seed);
+        }
+    }
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        keys.players[player] = GenerateHashKey(&seed);
+    }
+    for (unsigned char state = 0; state < NUM_OF_GAME_STATES; ++state)
+    {
+        keys.states[state] = GenerateHashKey(&seed);
+    }
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        for (unsigned char deck = 0; deck <= Geometry::NUM_OF_PIECES; ++deck)
+        {
+            keys.decks[player][deck] = GenerateHashKey(&seed);
+        }
+    }
+    for (unsigned char mills = 0; mills <= Geometry::NUM_OF_MILLS; ++mills)
+    {
+        keys.mills[mills] = GenerateHashKey(&seed);
+    }
+
+    return keys;
+}
+
+/**
+ * Random keys of the position hash of a geometry
+ *
+ * Generated at compile time, so games constructed during the static
+ * initialization of any translation unit already use them.
+ */
+template <typename Geometry>
+constexpr GameHashKeys<Geometry> GAME_HASH_KEYS = CreateGameHashKeys<Geometry>();
+
+/**
+ * Game of a board variant
+ *
+ * The places, mills and adjacency come from the geometry (see
+ * BoardGeometry.hpp) as compile time constants, every variant gets its
+ * own rule checks without looking up the geometry at runtime.
+ */
+template <typename Geometry>
+class BasicGame
 {
 private:
 
     /** @brief Field
-     * has 24 points, indexed like this:
+     * has the places of the geometry, for Nine Men's Morris 24 points, indexed like this:
      *
      * 0-----------1-----------2
      * |           |           |
@@ -44,7 +148,10 @@ private:
      * 1 - player 1
      * 2 - player 2
      */
-    std::array<unsigned char, NUM_OF_FIELD_PLACES> field = { 0 };
+    std::array<unsigned char, Geometry::NUM_OF_PLACES> field = { 0 };
+
+    /** Pieces of the players (bitboards of the field places occupied by the players) */
+    Bitboard pieces[NUM_OF_PLAYERS] = { 0 };
 
     /** State of the games */
     GameState state = GameState::Init;
@@ -59,51 +166,59 @@ private:
     unsigned char numOfPieces[NUM_OF_PLAYERS];
 
     /** Number of mills of the current player */
-    unsigned char numOfMills;
+    unsigned char numOfMills = 0;
+
+    /**
+     * Hash of the position
+     *
+     * Zobrist hash of the pieces, the current player, the game state,
+     * the decks and the number of mills of the current player,
+     * updated with every change of them.
+     */
+    unsigned long long hash = 0;
+
+    /** Random keys of the position hash (shared by the games) */
+    static constexpr const GameHashKeys<Geometry>& hashKeys = GAME_HASH_KEYS<Geometry>;
+
+    /** Statistics of the games of the current thread */
+    static thread_local GameStatistics statistics;
 
     /** Mills of the players */
-    std::array<std::vector<unsigned char>, NUM_OF_PLAYERS> mills;
-
-    /** Adjacent field places */
-    const std::array<std::vector<unsigned char>, NUM_OF_FIELD_PLACES> adjacentPlaces =
-    {{
-        { 1, 7 },
-        { 0, 2, 9 },
-        { 1, 3 },
-        { 2, 4, 11 },
-        { 3, 5 },
-        { 4, 6, 13 },
-        { 5, 7 },
-        { 0, 6, 15 },
-        { 9, 15 },
-        { 1, 8, 10, 17 },
-        { 9, 11 },
-        { 3, 10, 12, 19 },
-        { 11, 13 },
-        { 5, 12, 14, 21 },
-        { 13, 15 },
-        { 7, 8, 14, 23 },
-        { 17, 23 },
-        { 9, 16, 18 },
-        { 17, 19 },
-        { 11, 18, 20 },
-        { 19, 21 },
-        { 13, 20, 22 },
-        { 21, 23 },
-        { 15, 16, 22 }
-    }};
+    MillSet mills[NUM_OF_PLAYERS] = { 0 };
 
     /**
-     * Advance to next player
+     * Compute the hash of the position from scratch
+     *
+     * @return The hash of the position
      */
-    void NextPlayer();
+    unsigned long long ComputeHash();
 
     /**
-     * Check if the current player has move
+     * Set the game state
      *
-     * @return The current player has move
+     * @param[in] state The new game state
      */
-    bool CheckHasMove();
+    void SetState(GameState state);
+
+    /**
+     * Set the deck of a player
+     *
+     * @param[in] player The index of the player
+     * @param[in] value The number of pieces in the deck
+     */
+    void SetDeck(unsigned char player, unsigned char value);
+
+    /**
+     * Set the number of mills of the current player
+     *
+     * @param[in] value The number of mills
+     */
+    void SetNumberOfMills(unsigned char value);
+
+    /**
+     * Advance to next player
+     */
+    void NextPlayer();
 
     /**
      * Check placement of piece
@@ -126,61 +241,96 @@ private:
     bool CheckMove(unsigned char fromPoint, unsigned char toPoint = 255);
 
     /**
-     * Check removal of piece
+     * Check for mills
      *
-     * @param[in] point The point to remove from
-     * @param[in] currentPlayerCheck Check if current player's piece is at the point
+     * Update the mills of the current player
+     * and count the ones formed since the last check.
      *
-     * @return The removal of the piece is valid
+     * @return The current player has a new mill
      */
-    bool CheckRemove(unsigned char point, bool currentPlayerCheck = false);
+    bool CheckForMills();
+
+    // TODO: IMPLEMENT
+//     /**
+//      * Count pieces
+//      */
+//     void CountPieces();
 
     /**
-     * Check for mills
+     * Get the index of the opponent
      *
-     * @param[in,out] isMills Pointer to vector to store places for mills
+     * @return The index of the opponent of the current player
+     */
+    unsigned char GetOpponentIndex();
+
+    /**
+     * Set field place
      *
-     * @return The current player has a mill
+     * @param[in] place The place to set
+     * @param[in] value The value of the place (empty or player)
      */
-    bool CheckForMills(std::array<bool, NUM_OF_FIELD_PLACES>* isMills = nullptr);
+    void SetPlace(unsigned char place, unsigned char value);
+
+public:
+
+    // TODO: REMOVE
+    std::array<unsigned char, Geometry::NUM_OF_PLACES>* GetField();
 
     /**
-     * Check mill
+     * Consruct game
      *
-     * @param[in] place The beginning place of the mill
-     * @param[in,out] isMills Pointer to vector to store places for mills
+     * The starting player is selected by the generator of the current thread.
+     */
+    BasicGame();
+
+    /**
+     * Construct game with a random number generator
      *
-     * @return The given places has a mill
+     * @param[in,out] random Pointer to the generator to select the starting player with
      */
-    bool CheckMill(unsigned char mill, std::array<bool, NUM_OF_FIELD_PLACES>* isMills = nullptr);
+    explicit BasicGame(Random* random);
 
-    // TODO: IMPLEMENT
-//     /**
-//      * Count pieces
-//      */
-//     void CountPieces();
+    /**
+     * Construct game from a position
+     *
+     * An invalid position (see IsValidPosition) is not set, the game
+     * starts from the empty field with the first player to move instead.
+     *
+     * @param[in] position The position to continue from
+     */
+    explicit BasicGame(const GamePosition& position);
 
     /**
-     * @brief Get mill places
+     * Check a position
      *
-     * Get the places where a mill could be
-     * based on the place paramter given.
+     * The state and the current player must be in range, the pieces on
+     * the field, their counts and the decks must match and the mills
+     * must be formed by the pieces of their player. Removals are pending
+     * in the remove state only, at least one and at most as many as a
+     * single action can form (e.g. a remove position with no pending
+     * removal is invalid, it could not continue).
      *
-     * @param[in] place The beginning place of the mill
+     * @param[in] position The position to check
      *
-     * @return The array of the places
+     * @return The position is valid
      */
-    std::array<unsigned char, 3> GetMillPlaces(unsigned char place);
-
-public:
+    static bool IsValidPosition(const GamePosition& position);
 
-    // TODO: REMOVE
-    std::array<unsigned char, NUM_OF_FIELD_PLACES>* GetField();
+    /**
+     * Get the position
+     *
+     * @return The position of the game
+     */
+    GamePosition GetPosition();
 
     /**
-     * Consruct game
+     * Set the position
+     *
+     * @param[in] position The position to continue from (an invalid one leaves the game unchanged)
+     *
+     * @return The position is valid and set
      */
-    Game();
+    bool SetPosition(const GamePosition& position);
 
     /**
      * Get game state
@@ -203,6 +353,15 @@ public:
      */
     unsigned char GetDeck();
 
+    /**
+     * Get deck of a player
+     *
+     * @param[in] player The player (1 or 2)
+     *
+     * @return The number of pieces in the deck of the player
+     */
+    unsigned char GetDeck(unsigned char player);
+
     /**
      * Get number of pieces of the current player
      *
@@ -210,6 +369,24 @@ public:
      */
     unsigned char GetNumberOfPieces();
 
+    /**
+     * Get number of pieces of a player
+     *
+     * @param[in] player The player (1 or 2)
+     *
+     * @return The number of pieces of the player on the board
+     */
+    unsigned char GetNumberOfPieces(unsigned char player);
+
+    /**
+     * Get pieces of a player
+     *
+     * @param[in] player The player (1 or 2)
+     *
+     * @return The bitboard of the places occupied by the player
+     */
+    Bitboard GetPieces(unsigned char player);
+
     /**
      * Get number of mills of the current player
      *
@@ -217,11 +394,44 @@ public:
      */
     unsigned char GetNumberOfMills();
 
+    /**
+     * Get the actions of the current player
+     *
+     * Collect every action valid in the current game state.
+     *
+     * @param[out] actions Pointer to the list to store the actions in
+     */
+    void GetActions(GameActionList* actions);
+
+    /**
+     * Get the hash of the position
+     *
+     * @return The Zobrist hash of the position
+     */
+    unsigned long long GetHash();
+
     /**
      * Check the game state
      */
     void CheckState();
 
+    /**
+     * Check if the current player has move
+     *
+     * @return The current player has move
+     */
+    bool CheckHasMove();
+
+    /**
+     * Check removal of piece
+     *
+     * @param[in] point The point to remove from
+     * @param[in] currentPlayerCheck Check if current player's piece is at the point
+     *
+     * @return The removal of the piece is valid
+     */
+    bool CheckRemove(unsigned char point, bool currentPlayerCheck = false);
+
     /**
     * Place the piece
     *
@@ -244,11 +454,77 @@ public:
     /**
      * Remove the piece
      *
+     * The mills broken by the removal are forgotten, forming them again
+     * later counts as a new mill.
+     *
      * @param The point to remove from
      *
      * @return The removal of the piece is done
      */
     bool Remove(unsigned char point);
+
+    /**
+     * Apply an action
+     *
+     * Place, move or remove the piece based on the game state
+     * and check the game state.
+     *
+     * @param[in] action The action of the current player
+     * @param[out] undo Pointer to the record to store the undo information in
+     *
+     * @return The action is applied
+     */
+    bool Apply(GameAction action, GameUndo* undo = nullptr);
+
+    /**
+     * Undo an action
+     *
+     * Restore the game to the state before the action was applied.
+     *
+     * @param[in] undo The record of the last applied action
+     */
+    void Undo(const GameUndo& undo);
+
+    /**
+     * Get the statistics
+     *
+     * Collected only with MORRIS_STATISTICS defined.
+     *
+     * @return The statistics of the games of the current thread
+     */
+    static GameStatistics GetStatistics();
+
+    /**
+     * Reset the statistics of the games of the current thread
+     */
+    static void ResetStatistics();
+
+    static_assert(GetMaxNumberOfActions<Geometry>() <= MAX_NUM_OF_ACTIONS, "Actions must fit in GameActionList");
 };
 
+template <typename Geometry>
+inline unsigned char BasicGame<Geometry>::GetCurrentPlayer()
+{
+    return currentPlayer + 1;
+}
+
+extern template class BasicGame<ThreeMensMorris>;
+extern template class BasicGame<SixMensMorris>;
+extern template class BasicGame<NineMensMorris>;
+extern template class BasicGame<TwelveMensMorris>;
+
+/** Game of Nine Men's Morris */
+typedef BasicGame<NineMensMorris> Game;
+
+/** Game of Three Men's Morris */
+typedef BasicGame<ThreeMensMorris> ThreeMensMorrisGame;
+
+/** Game of Six Men's Morris */
+typedef BasicGame<SixMensMorris> SixMensMorrisGame;
+
+/** Game of Twelve Men's Morris */
+typedef BasicGame<TwelveMensMorris> TwelveMensMorrisGame;
+
+static_assert(std::is_trivially_copyable<Game>::value, "Game must be trivially copyable");
+
 #endif // GAME_H
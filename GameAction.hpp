@@ -0,0 +1,45 @@
+/**
+ * Game Action - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef GAME_ACTION_H
+#define GAME_ACTION_H
+
+#include <array>
+
+#include "GameConstants.hpp"
+
+/**
+ * Action of a player
+ *
+ * uses the places like the changes of the game steps:
+ * place - from is NO_PLACE, to is the place to place to
+ * move - from is the place to move from, to is the place to move to
+ * remove - from is the place to remove from, to is NO_PLACE
+ */
+struct GameAction
+{
+    /** Place to remove or move from */
+    unsigned char from;
+
+    /** Place to place or move to */
+    unsigned char to;
+};
+
+/** List of the actions of a player */
+struct GameActionList
+{
+    /** Actions */
+    std::array<GameAction, MAX_NUM_OF_ACTIONS> actions;
+
+    /** Number of actions */
+    unsigned char size = 0;
+};
+
+#endif // GAME_ACTION_H
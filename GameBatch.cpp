@@ -0,0 +1,649 @@
+/**
+ * Game Batch Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "GameBatch.hpp"
+
+#include <type_traits>
+
+#include "Game.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GAME_BATCH_X86
+#include <immintrin.h>
+#endif
+
+// The steps between the places follow the squares of Nine Men's Morris
+static_assert(std::is_same<Game, BasicGame<NineMensMorris>>::value,
+              "The batched games are implemented for Nine Men's Morris");
+
+/** First places of the squares */
+const Bitboard SQUARE_FIRST_PLACES = 0x010101;
+
+/** Last places of the squares */
+const Bitboard SQUARE_LAST_PLACES = 0x808080;
+
+/** Places connected to the next inner square */
+const Bitboard INWARD_PLACES = 0x00AAAA;
+
+/** Places connected to the next outer square */
+const Bitboard OUTWARD_PLACES = 0xAAAA00;
+
+/**
+ * Step the places forward on their squares (to the next place, the last to the first)
+ *
+ * @param[in] board The bitboard of the places
+ *
+ * @return The bitboard of the next places
+ */
+inline Bitboard StepForward(Bitboard board)
+{
+    return ((board << 1) & ~SQUARE_FIRST_PLACES & FULL_BOARD) | ((board >> 7) & SQUARE_FIRST_PLACES);
+}
+
+/**
+ * Step the places backward on their squares (to the previous place, the first to the last)
+ *
+ * @param[in] board The bitboard of the places
+ *
+ * @return The bitboard of the previous places
+ */
+inline Bitboard StepBackward(Bitboard board)
+{
+    return ((board >> 1) & ~SQUARE_LAST_PLACES) | ((board << 7) & SQUARE_LAST_PLACES);
+}
+
+/**
+ * Step the places to the next inner square (the places not connected are left out)
+ *
+ * @param[in] board The bitboard of the places
+ *
+ * @return The bitboard of the inner places
+ */
+inline Bitboard StepInward(Bitboard board)
+{
+    return (board & INWARD_PLACES) << 8;
+}
+
+/**
+ * Step the places to the next outer square (the places not connected are left out)
+ *
+ * @param[in] board The bitboard of the places
+ *
+ * @return The bitboard of the outer places
+ */
+inline Bitboard StepOutward(Bitboard board)
+{
+    return (board & OUTWARD_PLACES) >> 8;
+}
+
+/**
+ * Find the mills and the mobility of the pieces of a player
+ *
+ * @param[in] playerPieces The pieces of the player
+ * @param[in] opponentPieces The pieces of the opponent
+ * @param[out] playerMills Pointer to store the mills of the player in
+ * @param[out] playerMillPlaces Pointer to store the places of the mills in
+ * @param[out] playerMobile Pointer to store all bits set in if a piece is next to an empty place
+ */
+inline void AnalyzePieces(Bitboard playerPieces, Bitboard opponentPieces, unsigned int* playerMills,
+                          Bitboard* playerMillPlaces, unsigned int* playerMobile)
+{
+    MillSet mills = FindMills<NineMensMorris>(playerPieces);
+    Bitboard adjacentPlaces = StepForward(playerPieces) | StepBackward(playerPieces) | StepInward(playerPieces)
+                              | StepOutward(playerPieces);
+
+    *playerMills = mills;
+    *playerMillPlaces = GetMillPlaces<NineMensMorris>(mills);
+    *playerMobile = (adjacentPlaces & ~(playerPieces | opponentPieces)) != 0 ? ~0u : 0;
+}
+
+/**
+ * Find the mills and the mobility of the pieces of a player in the games one by one
+ *
+ * @param[in] playerPieces The pieces of the player in the games
+ * @param[in] opponentPieces The pieces of the opponent in the games
+ * @param[in] size The number of games
+ * @param[out] playerMills The mills of the player in the games
+ * @param[out] playerMillPlaces The places of the mills in the games
+ * @param[out] playerMobile The mobility of the player in the games
+ *
+ * @return The number of the processed games
+ */
+std::size_t AnalyzePlayer(const Bitboard* playerPieces, const Bitboard* opponentPieces, std::size_t size,
+                          unsigned int* playerMills, Bitboard* playerMillPlaces, unsigned int* playerMobile)
+{
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        AnalyzePieces(playerPieces[index], opponentPieces[index], &playerMills[index], &playerMillPlaces[index],
+                      &playerMobile[index]);
+    }
+
+    return size;
+}
+
+#if defined(GAME_BATCH_X86)
+
+/**
+ * Find the mills and the mobility of the pieces of a player in 4 games at once with SSE2
+ *
+ * @param[in] playerPieces The pieces of the player in the games
+ * @param[in] opponentPieces The pieces of the opponent in the games
+ * @param[in] size The number of games
+ * @param[out] playerMills The mills of the player in the games
+ * @param[out] playerMillPlaces The places of the mills in the games
+ * @param[out] playerMobile The mobility of the player in the games
+ *
+ * @return The number of the processed games (multiple of 4)
+ */
+__attribute__((target("sse2")))
+std::size_t AnalyzePlayerSse2(const Bitboard* playerPieces, const Bitboard* opponentPieces, std::size_t size,
+                              unsigned int* playerMills, Bitboard* playerMillPlaces, unsigned int* playerMobile)
+{
+    const __m128i fullBoard = _mm_set1_epi32(FULL_BOARD);
+    const __m128i squareFirstPlaces = _mm_set1_epi32(SQUARE_FIRST_PLACES);
+    const __m128i squareLastPlaces = _mm_set1_epi32(SQUARE_LAST_PLACES);
+    const __m128i inwardPlaces = _mm_set1_epi32(INWARD_PLACES);
+    const __m128i outwardPlaces = _mm_set1_epi32(OUTWARD_PLACES);
+    const __m128i zero = _mm_setzero_si128();
+
+    std::size_t index = 0;
+    for (; index + 4 <= size; index += 4)
+    {
+        __m128i pieces = _mm_loadu_si128(reinterpret_cast<const __m128i*>(playerPieces + index));
+        __m128i otherPieces = _mm_loadu_si128(reinterpret_cast<const __m128i*>(opponentPieces + index));
+
+        __m128i mills = zero;
+        __m128i millPlaces = zero;
+        for (unsigned char mill = 0; mill < NUM_OF_MILLS; ++mill)
+        {
+            __m128i millMask = _mm_set1_epi32(NineMensMorris::GetMillMask(mill));
+            __m128i found = _mm_cmpeq_epi32(_mm_and_si128(pieces, millMask), millMask);
+            mills = _mm_or_si128(mills, _mm_and_si128(found, _mm_set1_epi32(1 << mill)));
+            millPlaces = _mm_or_si128(millPlaces, _mm_and_si128(found, millMask));
+        }
+
+        __m128i forward = _mm_or_si128(_mm_andnot_si128(squareFirstPlaces,
+                                       _mm_and_si128(_mm_slli_epi32(pieces, 1), fullBoard)),
+                                       _mm_and_si128(_mm_srli_epi32(pieces, 7), squareFirstPlaces));
+        __m128i backward = _mm_or_si128(_mm_andnot_si128(squareLastPlaces, _mm_srli_epi32(pieces, 1)),
+                                        _mm_and_si128(_mm_slli_epi32(pieces, 7), squareLastPlaces));
+        __m128i inward = _mm_slli_epi32(_mm_and_si128(pieces, inwardPlaces), 8);
+        __m128i outward = _mm_srli_epi32(_mm_and_si128(pieces, outwardPlaces), 8);
+        __m128i adjacentPlaces = _mm_or_si128(_mm_or_si128(forward, backward), _mm_or_si128(inward, outward));
+        __m128i emptyAdjacentPlaces = _mm_andnot_si128(_mm_or_si128(pieces, otherPieces), adjacentPlaces);
+        __m128i mobile = _mm_andnot_si128(_mm_cmpeq_epi32(emptyAdjacentPlaces, zero), _mm_set1_epi32(-1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(playerMills + index), mills);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(playerMillPlaces + index), millPlaces);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(playerMobile + index), mobile);
+    }
+
+    return index;
+}
+
+/**
+ * Find the mills and the mobility of the pieces of a player in 8 games at once with AVX2
+ *
+ * @param[in] playerPieces The pieces of the player in the games
+ * @param[in] opponentPieces The pieces of the opponent in the games
+ * @param[in] size The number of games
+ * @param[out] playerMills The mills of the player in the games
+ * @param[out] playerMillPlaces The places of the mills in the games
+ * @param[out] playerMobile The mobility of the player in the games
+ *
+ * @return The number of the processed games (multiple of 8)
+ */
+__attribute__((target("avx2")))
+std::size_t AnalyzePlayerAvx2(const Bitboard* playerPieces, const Bitboard* opponentPieces, std::size_t size,
+                              unsigned int* playerMills, Bitboard* playerMillPlaces, unsigned int* playerMobile)
+{
+    const __m256i fullBoard = _mm256_set1_epi32(FULL_BOARD);
+    const __m256i squareFirstPlaces = _mm256_set1_epi32(SQUARE_FIRST_PLACES);
+    const __m256i squareLastPlaces = _mm256_set1_epi32(SQUARE_LAST_PLACES);
+    const __m256i inwardPlaces = _mm256_set1_epi32(INWARD_PLACES);
+    const __m256i outwardPlaces = _mm256_set1_epi32(OUTWARD_PLACES);
+    const __m256i zero = _mm256_setzero_si256();
+
+    std::size_t index = 0;
+    for (; index + 8 <= size; index += 8)
+    {
+        __m256i pieces = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(playerPieces + index));
+        __m256i otherPieces = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(opponentPieces + index));
+
+        __m256i mills = zero;
+        __m256i millPlaces = zero;
+        for (unsigned char mill = 0; mill < NUM_OF_MILLS; ++mill)
+        {
+            __m256i millMask = _mm256_set1_epi32(NineMensMorris::GetMillMask(mill));
+            __m256i found = _mm256_cmpeq_epi32(_mm256_and_si256(pieces, millMask), millMask);
+            mills = _mm256_or_si256(mills, _mm256_and_si256(found, _mm256_set1_epi32(1 << mill)));
+            millPlaces = _mm256_or_si256(millPlaces, _mm256_and_si256(found, millMask));
+        }
+
+        __m256i forward = _mm256_or_si256(_mm256_andnot_si256(squareFirstPlaces,
+                                          _mm256_and_si256(_mm256_slli_epi32(pieces, 1), fullBoard)),
+                                          _mm256_and_si256(_mm256_srli_epi32(pieces, 7), squareFirstPlaces));
+        __m256i backward = _mm256_or_si256(_mm256_andnot_si256(squareLastPlaces, _mm256_srli_epi32(pieces, 1)),
+                                           _mm256_and_si256(_mm256_slli_epi32(pieces, 7), squareLastPlaces));
+        __m256i inward = _mm256_slli_epi32(_mm256_and_si256(pieces, inwardPlaces), 8);
+        __m256i outward = _mm256_srli_epi32(_mm256_and_si256(pieces, outwardPlaces), 8);
+        __m256i adjacentPlaces = _mm256_or_si256(_mm256_or_si256(forward, backward),
+                                                 _mm256_or_si256(inward, outward));
+        __m256i emptyAdjacentPlaces = _mm256_andnot_si256(_mm256_or_si256(pieces, otherPieces), adjacentPlaces);
+        __m256i mobile = _mm256_andnot_si256(_mm256_cmpeq_epi32(emptyAdjacentPlaces, zero), _mm256_set1_epi32(-1));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(playerMills + index), mills);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(playerMillPlaces + index), millPlaces);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(playerMobile + index), mobile);
+    }
+
+    return index;
+}
+
+#endif // GAME_BATCH_X86
+
+GameBatch::GameBatch()
+{
+    // Select the widest vector instructions of the processor
+#if defined(GAME_BATCH_X86)
+    __builtin_cpu_init();
+    analyzeVector = __builtin_cpu_supports("avx2") ? AnalyzePlayerAvx2 : AnalyzePlayerSse2;
+#else
+    analyzeVector = AnalyzePlayer;
+#endif
+}
+
+void GameBatch::Reset(std::size_t numOfGames, Random* random, unsigned int maxNumOfSteps)
+{
+    size = numOfGames;
+    numOfActiveGames = numOfGames;
+    this->maxNumOfSteps = maxNumOfSteps;
+
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        pieces[player].assign(size, 0);
+        mills[player].assign(size, 0);
+        foundMillPlaces[player].assign(size, 0);
+        foundMills[player].assign(size, 0);
+        mobile[player].assign(size, 0);
+        decks[player].assign(size, 0);
+        numOfPieces[player].assign(size, 0);
+    }
+    active.assign(size, 0);
+    states.assign(size, GameState::Place);
+    currentPlayers.assign(size, 0);
+    numOfMills.assign(size, 0);
+    numOfSteps.assign(size, 0);
+    lastActions.assign(size, { NO_PLACE, NO_PLACE });
+
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        ResetGame(index, random);
+    }
+}
+
+void GameBatch::Restart(std::size_t index, Random* random)
+{
+    if (!active[index])
+    {
+        ++numOfActiveGames;
+    }
+    ResetGame(index, random);
+}
+
+bool GameBatch::SetPosition(std::size_t index, const GamePosition& position)
+{
+    // Validate the position like the games do
+    if (!Game::IsValidPosition(position))
+    {
+        return false;
+    }
+
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        pieces[player][index] = position.pieces[player];
+        mills[player][index] = position.mills[player];
+        decks[player][index] = position.deck[player];
+        numOfPieces[player][index] = position.numOfPieces[player];
+    }
+    states[index] = position.state;
+    currentPlayers[index] = position.currentPlayer - 1;
+    numOfMills[index] = position.numOfMills;
+    numOfSteps[index] = 0;
+    lastActions[index] = { NO_PLACE, NO_PLACE };
+
+    bool activated = position.state != GameState::End;
+    numOfActiveGames += activated;
+    numOfActiveGames -= active[index];
+    active[index] = activated;
+    AnalyzeGame(index);
+
+    return true;
+}
+
+GamePosition GameBatch::GetPosition(std::size_t index)
+{
+    GamePosition position;
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        position.pieces[player] = pieces[player][index];
+        position.mills[player] = mills[player][index];
+        position.deck[player] = decks[player][index];
+        position.numOfPieces[player] = numOfPieces[player][index];
+    }
+    position.state = states[index];
+    position.currentPlayer = currentPlayers[index] + 1;
+    position.numOfMills = numOfMills[index];
+
+    return position;
+}
+
+std::size_t GameBatch::Step(Random* random, std::vector<GameBatchResult>* finished)
+{
+    // Apply the actions, finish the games without any
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        if (active[index] && !ApplyRandomAction(index, random))
+        {
+            Finish(index, 0, finished);
+        }
+    }
+
+    // Change the states with the mills and the mobility after the actions
+    Analyze();
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        if (!active[index])
+        {
+            continue;
+        }
+
+        ++numOfSteps[index];
+        CheckState(index);
+
+        // The current player is the winner at the end of the game
+        if (states[index] == GameState::End)
+        {
+            Finish(index, currentPlayers[index] + 1, finished);
+        }
+        else if (numOfSteps[index] >= maxNumOfSteps)
+        {
+            Finish(index, 0, finished);
+        }
+    }
+
+    return numOfActiveGames;
+}
+
+bool GameBatch::IsActive(std::size_t index)
+{
+    return active[index];
+}
+
+GameAction GameBatch::GetLastAction(std::size_t index)
+{
+    return lastActions[index];
+}
+
+std::size_t GameBatch::GetSize()
+{
+    return size;
+}
+
+std::size_t GameBatch::GetNumberOfActiveGames()
+{
+    return numOfActiveGames;
+}
+
+void GameBatch::Analyze()
+{
+    std::size_t analyzed = 0;
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        analyzed = analyzeVector(pieces[player].data(), pieces[NUM_OF_PLAYERS - 1 - player].data(), size,
+                                 foundMills[player].data(), foundMillPlaces[player].data(), mobile[player].data());
+    }
+
+    for (std::size_t index = analyzed; index < size; ++index)
+    {
+        AnalyzeGame(index);
+    }
+}
+
+void GameBatch::AnalyzeGame(std::size_t index)
+{
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        AnalyzePieces(pieces[player][index], pieces[NUM_OF_PLAYERS - 1 - player][index], &foundMills[player][index],
+                      &foundMillPlaces[player][index], &mobile[player][index]);
+    }
+}
+
+bool GameBatch::ApplyRandomAction(std::size_t index, Random* random)
+{
+    unsigned char player = currentPlayers[index];
+    unsigned char opponent = NUM_OF_PLAYERS - 1 - player;
+    Bitboard playerPieces = pieces[player][index];
+    Bitboard opponentPieces = pieces[opponent][index];
+    Bitboard emptyPlaces = FULL_BOARD & ~(playerPieces | opponentPieces);
+    GameAction& action = lastActions[index];
+
+    switch (states[index])
+    {
+    case GameState::Place:
+    {
+        unsigned char numOfActions = CountPlaces(emptyPlaces);
+        if (numOfActions == 0)
+        {
+            return false;
+        }
+
+        action = { NO_PLACE, SelectPlace(emptyPlaces, random->Next(numOfActions)) };
+        pieces[player][index] |= GetPlaceMask(action.to);
+        --decks[player][index];
+        ++numOfPieces[player][index];
+        return true;
+    }
+
+    case GameState::Move:
+    {
+        if (numOfPieces[player][index] <= 3)
+        {
+            // Jump from any piece to any empty place
+            unsigned char numOfEmptyPlaces = CountPlaces(emptyPlaces);
+            unsigned int numOfActions = CountPlaces(playerPieces) * numOfEmptyPlaces;
+            if (numOfActions == 0)
+            {
+                return false;
+            }
+
+            unsigned int selected = random->Next(numOfActions);
+            action = { SelectPlace(playerPieces, selected / numOfEmptyPlaces),
+                       SelectPlace(emptyPlaces, selected % numOfEmptyPlaces)
+                     };
+        }
+        else
+        {
+            // Move in one of the directions, the pieces with an empty place in a direction are counted by direction
+            Bitboard movablePieces[] =
+            {
+                playerPieces & StepBackward(emptyPlaces), playerPieces & StepForward(emptyPlaces),
+                playerPieces & StepOutward(emptyPlaces), playerPieces & StepInward(emptyPlaces)
+            };
+            const signed char offsets[] = { 1, -1, 8, -8 };
+
+            unsigned int numOfActions = 0;
+            for (unsigned char direction = 0; direction < 4; ++direction)
+            {
+                numOfActions += CountPlaces(movablePieces[direction]);
+            }
+            if (numOfActions == 0)
+            {
+                return false;
+            }
+
+            unsigned int selected = random->Next(numOfActions);
+            unsigned char direction = 0;
+            for (; selected >= CountPlaces(movablePieces[direction]); ++direction)
+            {
+                selected -= CountPlaces(movablePieces[direction]);
+            }
+
+            // The squares have 8 places, the forward and backward steps wrap around them
+            unsigned char fromPlace = SelectPlace(movablePieces[direction], selected);
+            unsigned char toPlace = fromPlace + offsets[direction];
+            if (direction < 2)
+            {
+                toPlace = (fromPlace & ~(NUM_OF_SQUARE_PLACES - 1)) | (toPlace & (NUM_OF_SQUARE_PLACES - 1));
+            }
+            action = { fromPlace, toPlace };
+        }
+
+        pieces[player][index] ^= GetPlaceMask(action.from) | GetPlaceMask(action.to);
+        return true;
+    }
+
+    case GameState::Remove:
+    {
+        // Remove pieces not in mills or any piece if all of them are in mills
+        Bitboard millPlaces = foundMillPlaces[opponent][index];
+        Bitboard removablePieces = millPlaces == opponentPieces ? opponentPieces : opponentPieces & ~millPlaces;
+        unsigned char numOfActions = CountPlaces(removablePieces);
+        if (numOfActions == 0)
+        {
+            return false;
+        }
+
+        action = { SelectPlace(removablePieces, random->Next(numOfActions)), NO_PLACE };
+        pieces[opponent][index] &= ~GetPlaceMask(action.from);
+        --numOfPieces[opponent][index];
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+void GameBatch::CheckState(std::size_t index)
+{
+    unsigned char player = currentPlayers[index];
+    unsigned char opponent = NUM_OF_PLAYERS - 1 - player;
+    bool opponentHasMove = numOfPieces[opponent][index] <= 3 || mobile[opponent][index];
+
+    switch (states[index])
+    {
+    case GameState::Place:
+    case GameState::Move:
+    {
+        // Set game state to end if the opponent has not enough pieces
+        if (numOfPieces[opponent][index] < 3 && decks[opponent][index] == 0)
+        {
+            states[index] = GameState::End;
+            break;
+        }
+
+        // Set game state to remove if the current player has new mills
+        MillSet playerMills = foundMills[player][index];
+        numOfMills[index] = CountMills(playerMills & ~mills[player][index]);
+        mills[player][index] = playerMills;
+        if (numOfMills[index] > 0)
+        {
+            states[index] = GameState::Remove;
+            break;
+        }
+        currentPlayers[index] = opponent;
+
+        // Set game state to move if the opponent's deck is empty, to end if the opponent can't move
+        if (decks[opponent][index] == 0)
+        {
+            if (!opponentHasMove)
+            {
+                states[index] = GameState::End;
+                currentPlayers[index] = player;
+                break;
+            }
+            states[index] = GameState::Move;
+        }
+        break;
+    }
+
+    case GameState::Remove:
+    {
+        // Forget the broken mill of the opponent, forming it again is a new mill
+        mills[opponent][index] &= foundMills[opponent][index];
+
+        // Set game state to end if the opponent has not enough pieces (no removals are pending any more)
+        if (numOfPieces[opponent][index] < 3 && decks[opponent][index] == 0)
+        {
+            states[index] = GameState::End;
+            numOfMills[index] = 0;
+            break;
+        }
+
+        // Stay in this state if the current player still has mills
+        if (--numOfMills[index] > 0)
+        {
+            break;
+        }
+        currentPlayers[index] = opponent;
+
+        // Set game state to place if the opponent's deck is not empty
+        if (decks[opponent][index] > 0)
+        {
+            MillSet opponentMills = foundMills[opponent][index];
+            numOfMills[index] = CountMills(opponentMills & ~mills[opponent][index]);
+            mills[opponent][index] = opponentMills;
+            states[index] = GameState::Place;
+            break;
+        }
+
+        // Set game state to end if the opponent can't move, to move otherwise
+        if (!opponentHasMove)
+        {
+            states[index] = GameState::End;
+            currentPlayers[index] = player;
+            break;
+        }
+        states[index] = GameState::Move;
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+void GameBatch::Finish(std::size_t index, unsigned char winner, std::vector<GameBatchResult>* finished)
+{
+    active[index] = false;
+    --numOfActiveGames;
+    finished->push_back({ index, winner, numOfSteps[index] });
+}
+
+void GameBatch::ResetGame(std::size_t index, Random* random)
+{
+    for (unsigned char player = 0; player < NUM_OF_PLAYERS; ++player)
+    {
+        pieces[player][index] = 0;
+        mills[player][index] = 0;
+        foundMillPlaces[player][index] = 0;
+        foundMills[player][index] = 0;
+        mobile[player][index] = 0;
+        decks[player][index] = NUM_OF_PIECES;
+        numOfPieces[player][index] = 0;
+    }
+    active[index] = true;
+    states[index] = GameState::Place;
+    currentPlayers[index] = random->Next(NUM_OF_PLAYERS);
+    numOfMills[index] = 0;
+    numOfSteps[index] = 0;
+    lastActions[index] = { NO_PLACE, NO_PLACE };
+}
@@ -0,0 +1,243 @@
+/**
+ * Game Batch Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef GAME_BATCH_H
+#define GAME_BATCH_H
+
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "GameAction.hpp"
+#include "GamePosition.hpp"
+#include "Random.hpp"
+
+/** Maximum number of steps of a game in a batch (longer games are finished as draws) */
+const unsigned int GAME_BATCH_MAX_NUM_OF_STEPS = 1000;
+
+/** Result of a finished game of a batch */
+struct GameBatchResult
+{
+    /** Index of the game in the batch */
+    std::size_t index;
+
+    /** Winner of the game (1 or 2, 0 if the game reached the maximum number of steps) */
+    unsigned char winner;
+
+    /** Number of steps of the game */
+    unsigned int numOfSteps;
+};
+
+/**
+ * Batch of games played with random actions
+ *
+ * The games are stored as structure of arrays. The mills and the
+ * mobility of the pieces are found for all the games at once with
+ * AVX2 or SSE2 (selected by the processor) or one by one without them,
+ * the actions are selected and the states are changed game by game with
+ * the rules of Game.
+ */
+class GameBatch
+{
+private:
+    /** Pieces of the players (bitboards per game) */
+    std::vector<Bitboard> pieces[NUM_OF_PLAYERS];
+
+    /** Mills of the players */
+    std::vector<MillSet> mills[NUM_OF_PLAYERS];
+
+    /** Places of the mills found of the players */
+    std::vector<Bitboard> foundMillPlaces[NUM_OF_PLAYERS];
+
+    /** Mills found of the players (stored like the bitboards for the vector instructions) */
+    std::vector<unsigned int> foundMills[NUM_OF_PLAYERS];
+
+    /** Players have pieces next to empty places (all bits set if they have) */
+    std::vector<unsigned int> mobile[NUM_OF_PLAYERS];
+
+    /** Games are active (not finished) */
+    std::vector<unsigned char> active;
+
+    /** States of the games (GameState) */
+    std::vector<unsigned char> states;
+
+    /** Indexes of the current players */
+    std::vector<unsigned char> currentPlayers;
+
+    /** Decks of the players */
+    std::vector<unsigned char> decks[NUM_OF_PLAYERS];
+
+    /** Number of pieces of the players */
+    std::vector<unsigned char> numOfPieces[NUM_OF_PLAYERS];
+
+    /** Number of mills of the current players */
+    std::vector<unsigned char> numOfMills;
+
+    /** Number of steps of the games */
+    std::vector<unsigned int> numOfSteps;
+
+    /** Last actions of the games */
+    std::vector<GameAction> lastActions;
+
+    /** Maximum number of steps of a game */
+    unsigned int maxNumOfSteps = GAME_BATCH_MAX_NUM_OF_STEPS;
+
+    /** Number of games */
+    std::size_t size = 0;
+
+    /** Number of active games */
+    std::size_t numOfActiveGames = 0;
+
+    /**
+     * Function finding the mills and the mobility of the pieces of a player in the games
+     *
+     * Processes the games in groups fitting the vector registers,
+     * returns the number of the processed games (the rest is processed
+     * one by one).
+     */
+    std::size_t (*analyzeVector)(const Bitboard* playerPieces, const Bitboard* opponentPieces, std::size_t size,
+                                 unsigned int* playerMills, Bitboard* playerMillPlaces, unsigned int* playerMobile);
+
+    /**
+     * Find the mills and the mobility of the pieces in the games
+     */
+    void Analyze();
+
+    /**
+     * Find the mills and the mobility of the pieces in a game
+     *
+     * @param[in] index The index of the game
+     */
+    void AnalyzeGame(std::size_t index);
+
+    /**
+     * Select and apply a random action
+     *
+     * @param[in] index The index of the game
+     * @param[in,out] random Pointer to the generator to select the action with
+     *
+     * @return An action is applied
+     */
+    bool ApplyRandomAction(std::size_t index, Random* random);
+
+    /**
+     * Change the state of a game after an action
+     *
+     * Follows Game::CheckState with the mills and the mobility found after the action.
+     *
+     * @param[in] index The index of the game
+     */
+    void CheckState(std::size_t index);
+
+    /**
+     * Finish a game
+     *
+     * @param[in] index The index of the game
+     * @param[in] winner The winner (1 or 2, 0 for no winner)
+     * @param[out] finished Pointer to append the result to
+     */
+    void Finish(std::size_t index, unsigned char winner, std::vector<GameBatchResult>* finished);
+
+    /**
+     * Reset a game to the starting position
+     *
+     * @param[in] index The index of the game
+     * @param[in,out] random Pointer to the generator to select the starting player with
+     */
+    void ResetGame(std::size_t index, Random* random);
+
+public:
+
+    /**
+     * Construct game batch
+     */
+    GameBatch();
+
+    /**
+     * Start new games
+     *
+     * @param[in] numOfGames The number of games
+     * @param[in,out] random Pointer to the generator to select the starting players with
+     * @param[in] maxNumOfSteps The maximum number of steps of a game
+     */
+    void Reset(std::size_t numOfGames, Random* random, unsigned int maxNumOfSteps = GAME_BATCH_MAX_NUM_OF_STEPS);
+
+    /**
+     * Start a new game in place of a game
+     *
+     * @param[in] index The index of the game
+     * @param[in,out] random Pointer to the generator to select the starting player with
+     */
+    void Restart(std::size_t index, Random* random);
+
+    /**
+     * Set the position of a game
+     *
+     * @param[in] index The index of the game
+     * @param[in] position The position to continue from (validated like Game::SetPosition)
+     *
+     * @return The position is valid and set
+     */
+    bool SetPosition(std::size_t index, const GamePosition& position);
+
+    /**
+     * Get the position of a game
+     *
+     * @param[in] index The index of the game
+     *
+     * @return The position of the game
+     */
+    GamePosition GetPosition(std::size_t index);
+
+    /**
+     * Advance the active games by a step
+     *
+     * Apply a random valid action in every active game.
+     *
+     * @param[in,out] random Pointer to the generator to select the actions with
+     * @param[out] finished Pointer to append the results of the finished games to
+     *
+     * @return The number of active games left
+     */
+    std::size_t Step(Random* random, std::vector<GameBatchResult>* finished);
+
+    /**
+     * Is a game active?
+     *
+     * @param[in] index The index of the game
+     *
+     * @return The game is not finished
+     */
+    bool IsActive(std::size_t index);
+
+    /**
+     * Get the last action of a game
+     *
+     * @param[in] index The index of the game
+     *
+     * @return The action applied by the last step
+     */
+    GameAction GetLastAction(std::size_t index);
+
+    /**
+     * Get the number of games
+     *
+     * @return The number of games of the batch
+     */
+    std::size_t GetSize();
+
+    /**
+     * Get the number of active games
+     *
+     * @return The number of games not finished
+     */
+    std::size_t GetNumberOfActiveGames();
+};
+
+#endif // GAME_BATCH_H
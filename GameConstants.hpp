@@ -26,10 +26,23 @@ const unsigned char NUM_OF_FIELD_PLACES = NUM_OF_SQUARES * NUM_OF_SQUARE_PLACES;
 /** Number of places to shift for next side starting point */
 const unsigned char NUM_OF_PLACES_TO_SHIFT = NUM_OF_SQUARE_PLACES / 4;
 
+/** Number of possible mills in the field (sides of the squares and connections of the squares) */
+const unsigned char NUM_OF_MILLS = NUM_OF_SQUARES * NUM_OF_SQUARE_PLACES / NUM_OF_PLACES_TO_SHIFT
+                                   + NUM_OF_SQUARE_PLACES / NUM_OF_PLACES_TO_SHIFT;
+
 /** Number of players */
 const unsigned char NUM_OF_PLAYERS = 2;
 
+/** Number of game states */
+const unsigned char NUM_OF_GAME_STATES = 5;
+
 /** Empty field place */
 const unsigned char EMPTY_PLACE = 0;
 
+/** No field place (not used part of an action) */
+const unsigned char NO_PLACE = 255;
+
+/** Maximum number of actions of a player (moving 3 pieces to any empty place) */
+const unsigned char MAX_NUM_OF_ACTIONS = 3 * (NUM_OF_FIELD_PLACES - 3);
+
 #endif // GAME_CONSTANTS_H
@@ -0,0 +1,53 @@
+/**
+ * Game Position - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef GAME_POSITION_H
+#define GAME_POSITION_H
+
+#include <type_traits>
+
+#include "Bitboard.hpp"
+#include "GameConstants.hpp"
+#include "GameState.hpp"
+
+/**
+ * Position of a game
+ *
+ * Everything a game continues from, without the field and the hash
+ * derived from it. Trivially copyable, positions can be copied with
+ * memcpy and kept in memory in large numbers.
+ */
+struct GamePosition
+{
+    /** Pieces of the players (bitboards of the field places occupied by the players) */
+    Bitboard pieces[NUM_OF_PLAYERS];
+
+    /** Mills of the players */
+    MillSet mills[NUM_OF_PLAYERS];
+
+    /** State of the game (GameState) */
+    unsigned char state;
+
+    /** Current player (1 or 2) */
+    unsigned char currentPlayer;
+
+    /** Deck of the players (number of pieces not placed yet) */
+    unsigned char deck[NUM_OF_PLAYERS];
+
+    /** Number of pieces of the players */
+    unsigned char numOfPieces[NUM_OF_PLAYERS];
+
+    /** Number of mills of the current player (pieces to remove) */
+    unsigned char numOfMills;
+};
+
+static_assert(std::is_trivially_copyable<GamePosition>::value, "GamePosition must be trivially copyable");
+
+#endif // GAME_POSITION_H
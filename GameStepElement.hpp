@@ -25,13 +25,10 @@ struct GameStepElement
     unsigned char changes1 = 255;
 
     /** Wins with this state */
-    unsigned short wins = 0;
+    unsigned int wins = 0;
 
     /** Losses with this state */
-    unsigned short losses = 0;
-
-    /** Balance of the wins and losses */
-    long balance = 0;
+    unsigned int losses = 0;
 };
 
 #endif // GAME_STEP_ELEMENT_H
@@ -0,0 +1,163 @@
+/**
+ * Game Step Storage Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "GameStepStorage.hpp"
+
+/** Minimum size of the hash table */
+const std::size_t MIN_NUM_OF_SLOTS = 16;
+
+std::size_t GameStepStorage::GetSlot(unsigned long long stateKey) const
+{
+    std::size_t mask = firstIndexes.size() - 1;
+    unsigned long long hash = stateKey * 0x9E3779B97F4A7C15ull;
+    std::size_t slot = static_cast<std::size_t>(hash ^ (hash >> 32)) & mask;
+
+    // Probe the following slots until the state or an empty slot is found
+    while (firstIndexes[slot] != NO_STEP_LINK && keys[firstIndexes[slot]] >> 16 != stateKey)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+void GameStepStorage::Rehash(std::size_t size)
+{
+    firstIndexes.assign(size, NO_STEP_LINK);
+
+    // Chain the game steps again in the order of insertion
+    std::vector<std::uint32_t> lastIndexes(size, NO_STEP_LINK);
+    for (std::uint32_t index = 0; index < keys.size(); ++index)
+    {
+        std::size_t slot = GetSlot(keys[index] >> 16);
+        nextIndexes[index] = NO_STEP_LINK;
+        if (firstIndexes[slot] == NO_STEP_LINK)
+        {
+            firstIndexes[slot] = index;
+        }
+        else
+        {
+            nextIndexes[lastIndexes[slot]] = index;
+        }
+        lastIndexes[slot] = index;
+    }
+}
+
+void GameStepStorage::Clear()
+{
+    keys.clear();
+    wins.clear();
+    losses.clear();
+    nextIndexes.clear();
+    firstIndexes.clear();
+    numOfStates = 0;
+}
+
+std::size_t GameStepStorage::GetMemorySize() const
+{
+    return keys.capacity() * sizeof(unsigned long long) + (wins.capacity() + losses.capacity()) * sizeof(unsigned int)
+           + (nextIndexes.capacity() + firstIndexes.capacity()) * sizeof(std::uint32_t);
+}
+
+void GameStepStorage::Reserve(std::size_t size)
+{
+    if (size > MAX_NUM_OF_STEPS)
+    {
+        size = MAX_NUM_OF_STEPS;
+    }
+
+    keys.reserve(size);
+    wins.reserve(size);
+    losses.reserve(size);
+    nextIndexes.reserve(size);
+
+    // Keep the hash table at most half full even if every game step has its own state
+    std::size_t numOfSlots = firstIndexes.empty() ? MIN_NUM_OF_SLOTS : firstIndexes.size();
+    while (numOfSlots < size * 2)
+    {
+        numOfSlots *= 2;
+    }
+    if (numOfSlots != firstIndexes.size())
+    {
+        Rehash(numOfSlots);
+    }
+}
+
+std::size_t GameStepStorage::Find(unsigned long long key) const
+{
+    for (std::size_t index = GetFirst(key >> 16); index != NO_STEP_INDEX; index = GetNext(index))
+    {
+        if (keys[index] == key)
+        {
+            return index;
+        }
+    }
+
+    return NO_STEP_INDEX;
+}
+
+std::size_t GameStepStorage::GetFirst(unsigned long long stateKey) const
+{
+    if (firstIndexes.empty())
+    {
+        return NO_STEP_INDEX;
+    }
+
+    std::uint32_t index = firstIndexes[GetSlot(stateKey)];
+    return index == NO_STEP_LINK ? NO_STEP_INDEX : index;
+}
+
+std::size_t GameStepStorage::Insert(unsigned long long key, unsigned int wins, unsigned int losses)
+{
+    if (keys.size() >= MAX_NUM_OF_STEPS)
+    {
+        return NO_STEP_INDEX;
+    }
+
+    if ((numOfStates + 1) * 2 > firstIndexes.size())
+    {
+        Rehash(firstIndexes.empty() ? MIN_NUM_OF_SLOTS : firstIndexes.size() * 2);
+    }
+
+    std::uint32_t index = static_cast<std::uint32_t>(keys.size());
+    keys.push_back(key);
+    this->wins.push_back(wins);
+    this->losses.push_back(losses);
+    nextIndexes.push_back(NO_STEP_LINK);
+
+    // Append the game step to the chain of its state
+    std::size_t slot = GetSlot(key >> 16);
+    if (firstIndexes[slot] == NO_STEP_LINK)
+    {
+        firstIndexes[slot] = index;
+        ++numOfStates;
+        return index;
+    }
+
+    std::uint32_t lastIndex = firstIndexes[slot];
+    while (nextIndexes[lastIndex] != NO_STEP_LINK)
+    {
+        lastIndex = nextIndexes[lastIndex];
+    }
+    nextIndexes[lastIndex] = index;
+
+    return index;
+}
+
+void GameStepStorage::AddResults(std::size_t index, unsigned int wins, unsigned int losses)
+{
+    this->wins[index] = AddStepCount(this->wins[index], wins);
+    this->losses[index] = AddStepCount(this->losses[index], losses);
+}
+
+StorageFileRecord GameStepStorage::GetRecord(std::size_t index) const
+{
+    return { keys[index], wins[index], losses[index] };
+}
@@ -0,0 +1,269 @@
+/**
+ * Game Step Storage Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef GAME_STEP_STORAGE_H
+#define GAME_STEP_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "StorageFile.hpp"
+
+/** Index of no game step */
+const std::size_t NO_STEP_INDEX = static_cast<std::size_t>(-1);
+
+/** Link to no game step (in the 4 byte wide chains and hash table) */
+const std::uint32_t NO_STEP_LINK = 0xFFFFFFFF;
+
+/** Maximum number of game steps in the storage (the indexes must fit in the links) */
+const std::size_t MAX_NUM_OF_STEPS = NO_STEP_LINK;
+
+/** Maximum value of the win and loss counters (they saturate instead of wrapping) */
+const unsigned int MAX_STEP_COUNT = 0xFFFFFFFF;
+
+/**
+ * Add to a win or loss counter
+ *
+ * @param[in] count The counter
+ * @param[in] addition The value to add
+ *
+ * @return The sum saturated at MAX_STEP_COUNT
+ */
+inline unsigned int AddStepCount(unsigned int count, unsigned int addition)
+{
+    return addition > MAX_STEP_COUNT - count ? MAX_STEP_COUNT : count + addition;
+}
+
+/**
+ * Get the balance of the wins and losses
+ *
+ * @param[in] wins The number of wins
+ * @param[in] losses The number of losses
+ *
+ * @return The wins minus the losses
+ */
+inline long long GetStepBalance(unsigned int wins, unsigned int losses)
+{
+    return static_cast<long long>(wins) - losses;
+}
+
+/**
+ * Storage of the game steps
+ *
+ * The game steps are stored as structure of arrays, the 8 byte keys
+ * (state << 16 | changes0 << 8 | changes1, as in the storage files)
+ * and the counters are in separate arrays. The steps of the same state
+ * are chained, the first step of every state is found by an open
+ * addressing hash table of the state keys. The links of the chains and
+ * the hash table are 4 bytes wide, the storage holds at most
+ * MAX_NUM_OF_STEPS game steps.
+ */
+class GameStepStorage
+{
+private:
+    /** Keys of the game steps */
+    std::vector<unsigned long long> keys;
+
+    /** Wins of the game steps */
+    std::vector<unsigned int> wins;
+
+    /** Losses of the game steps */
+    std::vector<unsigned int> losses;
+
+    /** Index of the next game step of the same state */
+    std::vector<std::uint32_t> nextIndexes;
+
+    /** Hash table of the index of the first game step of the states */
+    std::vector<std::uint32_t> firstIndexes;
+
+    /** Number of states */
+    std::size_t numOfStates = 0;
+
+    /**
+     * Get the slot of a state in the hash table
+     *
+     * @param[in] stateKey The packed state of the game field
+     *
+     * @return The slot of the state or the empty slot to insert it to
+     */
+    std::size_t GetSlot(unsigned long long stateKey) const;
+
+    /**
+     * Resize the hash table
+     *
+     * @param[in] size The new size of the hash table (power of 2)
+     */
+    void Rehash(std::size_t size);
+
+public:
+
+    /**
+     * Get the number of game steps
+     *
+     * @return The number of game steps in the storage
+     */
+    std::size_t GetSize() const;
+
+    /**
+     * Check if there are no game steps
+     *
+     * @return The storage is empty
+     */
+    bool IsEmpty() const;
+
+    /**
+     * Get the memory size
+     *
+     * @return The number of bytes allocated for the game steps and the hash table
+     */
+    std::size_t GetMemorySize() const;
+
+    /**
+     * Remove every game step
+     */
+    void Clear();
+
+    /**
+     * Reserve space for game steps
+     *
+     * @param[in] size The number of game steps to reserve space for (at most MAX_NUM_OF_STEPS is reserved)
+     */
+    void Reserve(std::size_t size);
+
+    /**
+     * Find a game step
+     *
+     * @param[in] key The key of the game step
+     *
+     * @return The index of the game step or NO_STEP_INDEX if not found
+     */
+    std::size_t Find(unsigned long long key) const;
+
+    /**
+     * Get the first game step of a state
+     *
+     * @param[in] stateKey The packed state of the game field
+     *
+     * @return The index of the game step or NO_STEP_INDEX if there is none
+     */
+    std::size_t GetFirst(unsigned long long stateKey) const;
+
+    /**
+     * Get the next game step of the same state
+     *
+     * @param[in] index The index of the game step
+     *
+     * @return The index of the next game step or NO_STEP_INDEX if there is none
+     */
+    std::size_t GetNext(std::size_t index) const;
+
+    /**
+     * Insert a game step (the key must not be in the storage)
+     *
+     * @param[in] key The key of the game step
+     * @param[in] wins The number of wins
+     * @param[in] losses The number of losses
+     *
+     * @return The index of the game step or NO_STEP_INDEX if the storage is full (nothing is inserted)
+     */
+    std::size_t Insert(unsigned long long key, unsigned int wins, unsigned int losses);
+
+    /**
+     * Add results to a game step
+     *
+     * @param[in] index The index of the game step
+     * @param[in] wins The number of wins to add
+     * @param[in] losses The number of losses to add
+     */
+    void AddResults(std::size_t index, unsigned int wins, unsigned int losses);
+
+    /**
+     * Get the key of a game step
+     *
+     * @param[in] index The index of the game step
+     *
+     * @return The key of the game step
+     */
+    unsigned long long GetKey(std::size_t index) const;
+
+    /**
+     * Get the wins of a game step
+     *
+     * @param[in] index The index of the game step
+     *
+     * @return The number of wins
+     */
+    unsigned int GetWins(std::size_t index) const;
+
+    /**
+     * Get the losses of a game step
+     *
+     * @param[in] index The index of the game step
+     *
+     * @return The number of losses
+     */
+    unsigned int GetLosses(std::size_t index) const;
+
+    /**
+     * Get the balance of a game step
+     *
+     * @param[in] index The index of the game step
+     *
+     * @return The wins minus the losses
+     */
+    long long GetBalance(std::size_t index) const;
+
+    /**
+     * Get a game step as storage file record
+     *
+     * @param[in] index The index of the game step
+     *
+     * @return The storage file record
+     */
+    StorageFileRecord GetRecord(std::size_t index) const;
+};
+
+inline std::size_t GameStepStorage::GetSize() const
+{
+    return keys.size();
+}
+
+inline bool GameStepStorage::IsEmpty() const
+{
+    return keys.empty();
+}
+
+inline std::size_t GameStepStorage::GetNext(std::size_t index) const
+{
+    return nextIndexes[index] == NO_STEP_LINK ? NO_STEP_INDEX : nextIndexes[index];
+}
+
+inline unsigned long long GameStepStorage::GetKey(std::size_t index) const
+{
+    return keys[index];
+}
+
+inline unsigned int GameStepStorage::GetWins(std::size_t index) const
+{
+    return wins[index];
+}
+
+inline unsigned int GameStepStorage::GetLosses(std::size_t index) const
+{
+    return losses[index];
+}
+
+inline long long GameStepStorage::GetBalance(std::size_t index) const
+{
+    return GetStepBalance(wins[index], losses[index]);
+}
+
+#endif // GAME_STEP_STORAGE_H
@@ -0,0 +1,41 @@
+/**
+ * Game Undo - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef GAME_UNDO_H
+#define GAME_UNDO_H
+
+#include "Bitboard.hpp"
+#include "GameAction.hpp"
+#include "GameConstants.hpp"
+#include "GameState.hpp"
+
+/** Record to undo an action of a player */
+struct GameUndo
+{
+    /** The applied action */
+    GameAction action;
+
+    /** State of the game before the action */
+    GameState state;
+
+    /** Index of the player applied the action */
+    unsigned char currentPlayer;
+
+    /** Number of mills of the current player before the action */
+    unsigned char numOfMills;
+
+    /** Mills of the players before the action */
+    MillSet mills[NUM_OF_PLAYERS];
+
+    /** Hash of the position before the action */
+    unsigned long long hash;
+};
+
+#endif // GAME_UNDO_H
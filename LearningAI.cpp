@@ -10,10 +10,12 @@
 
 #include "LearningAI.hpp"
 
-#include <cstdlib>
-#include <ctime>
+#include <cstdio>
 #include <fstream>
 
+#include "StorageFileWriter.hpp"
+#include "Symmetry.hpp"
+
 // TODO: REWORK LOGGING
 // #include "../eMorrisGUI/_Source/engine/UtilityFunctions.hpp"
 // #include <bitset>
@@ -28,8 +30,20 @@
 //     return ss.str();
 // }
 
+LearningAI::~LearningAI()
+{
+    StopBackground();
+
+    delete history;
+    delete storage;
+    delete storageFile;
+    delete journal;
+}
+
 bool LearningAI::Initialize(Game* game, bool spectator)
 {
+    StopBackground();
+
     this->game = game;
     if (game == nullptr)
     {
@@ -39,11 +53,17 @@ bool LearningAI::Initialize(Game* game, bool spectator)
     // Set spectating mode
     this->spectator = spectator;
 
-    // Initialize random generator
-    srand(time(nullptr));
-
+    // Initializing again starts with an empty storage
+    delete history;
+    delete storage;
+    delete storageFile;
+    delete journal;
     history = new std::vector<GameStepElement>();
-    storage = new std::vector<GameStepElement>();
+    storage = new GameStepStorage();
+    storageFile = new StorageFile();
+    journal = new StorageJournal();
+    storageFileName.clear();
+    journalFileName.clear();
 
     return true;
 }
@@ -53,8 +73,57 @@ bool LearningAI::IsSpectator()
     return spectator;
 }
 
-bool LearningAI::Load(std::string fileName)
+void LearningAI::Seed(unsigned long long seed)
 {
+    random.Seed(seed);
+}
+
+bool LearningAI::Load(std::string fileName, bool raw)
+{
+    WaitForWorker();
+
+    if (StorageFile::IsStorageFile(fileName))
+    {
+        // Map the storage file if nothing is loaded yet
+        if (storage->IsEmpty() && !storageFile->IsOpen())
+        {
+            if (!storageFile->Open(fileName))
+            {
+                return false;
+            }
+            storageFileName = fileName;
+
+            Replay(fileName, storageFile->GetChecksum());
+            return true;
+        }
+
+        // Merge the storage file into the storage otherwise
+        StorageFile mergedFile;
+        if (!mergedFile.Open(fileName))
+        {
+//             Log("AI", "Loading storage file \"" + fileName + "\" failed.", true, true);
+            return false;
+        }
+
+        std::vector<StorageFileRecord> records;
+        records.reserve(mergedFile.GetNumberOfRecords());
+        for (std::size_t index = 0; index < mergedFile.GetNumberOfRecords(); ++index)
+        {
+            records.push_back(mergedFile.GetRecord(index));
+        }
+        MergeRecords(&records);
+
+        Replay(fileName, mergedFile.GetChecksum());
+        return true;
+    }
+
+    // Raw storage files have no version to check
+    if (!raw)
+    {
+//         Log("AI", "Storage file \"" + fileName + "\" is not versioned.", true, true);
+        return false;
+    }
+
     std::ifstream file;
     file.open(fileName, std::ios::in | std::ios::binary);
     if (!file.is_open())
@@ -64,24 +133,14 @@ bool LearningAI::Load(std::string fileName)
         return false;
     }
 
+    // Calculate the checksum of the records as in the file, to replay the journal of the file
+    unsigned long long checksum = STORAGE_FILE_CHECKSUM_BASIS;
+    std::vector<StorageFileRecord> records;
+    StorageFileRecord record;
     file.seekg (0, std::ios::beg);
-    while (file.good())
+    while (ReadRawRecord(&file, &record, &checksum))
     {
-        GameStepElement step;
-        file.read(reinterpret_cast<char*>(&step.state0), sizeof(step.state0));
-        file.read(reinterpret_cast<char*>(&step.state1), sizeof(step.state1));
-        file.read(reinterpret_cast<char*>(&step.state2), sizeof(step.state2));
-        file.read(reinterpret_cast<char*>(&step.changes0), sizeof(step.changes0));
-        file.read(reinterpret_cast<char*>(&step.changes1), sizeof(step.changes1));
-        file.read(reinterpret_cast<char*>(&step.wins), sizeof(step.wins));
-        file.read(reinterpret_cast<char*>(&step.losses), sizeof(step.losses));
-        storage->push_back(step);
-    }
-
-    // Calculate balance
-    for (std::vector<GameStepElement>::iterator i = storage->begin(); i != storage->end(); ++i)
-    {
-        (*i).balance = (*i).wins - (*i).losses;
+        records.push_back(record);
     }
 
     // TODO: REMOVE LOGGING
@@ -99,53 +158,459 @@ bool LearningAI::Load(std::string fileName)
     }
 
     file.close();
+    MergeRecords(&records);
+    Replay(fileName, checksum);
     return true;
 }
 
-bool LearningAI::Save(std::string fileName)
+bool LearningAI::Save(std::string fileName, StorageFormat format)
 {
-    std::ofstream file;
-    file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
-    if (!file.is_open())
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queuedSaves.push_back({ fileName, format });
+        }
+        queueCondition.notify_all();
+        return true;
+    }
+
+    return SaveStorage(fileName, format);
+}
+
+bool LearningAI::SaveStorage(std::string fileName, StorageFormat format)
+{
+    StatisticsTimer timer(&statistics.saveNanoseconds);
+    STATISTICS_COUNT(statistics.numOfSaves);
+
+    // Saving the storage file of the journal compacts the journal (opening it again after a failed append)
+    if (!journalFileName.empty() && fileName == journalFileName)
+    {
+        journalFormat = format;
+        return Compact();
+    }
+
+    unsigned long long checksum;
+    return Write(fileName, format, &checksum);
+}
+
+bool LearningAI::MergeFile(std::string fileName, StorageMerge* merge)
+{
+    unsigned long long checksum = STORAGE_FILE_CHECKSUM_BASIS;
+    if (StorageFile::IsStorageFile(fileName))
+    {
+        StorageFile file;
+        if (!file.Open(fileName) || !merge->AddFile(fileName))
+        {
+            return false;
+        }
+        checksum = file.GetChecksum();
+    }
+    else
+    {
+        std::ifstream file;
+        file.open(fileName, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        StorageFileRecord record;
+        while (ReadRawRecord(&file, &record, &checksum))
+        {
+            if (!merge->Add(record))
+            {
+                return false;
+            }
+        }
+        if (file.fail())
+        {
+            return false;
+        }
+    }
+
+    // Add the journal continuing the file
+    std::vector<StorageFileRecord> records;
+    if (StorageJournal::Read(StorageJournal::GetFileName(fileName), checksum, &records))
+    {
+        for (std::vector<StorageFileRecord>::const_iterator ri = records.cbegin(); ri != records.cend(); ++ri)
+        {
+            if (!merge->Add(*ri))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool LearningAI::OpenJournal(std::string fileName, StorageFormat format)
+{
+    WaitForWorker();
+
+    CloseJournal();
+
+    // Load the storage file with its journal (a new storage file is created otherwise)
+    std::ifstream file(fileName);
+    if (file.good() && !Load(fileName))
+    {
+        return false;
+    }
+    file.close();
+
+    journalFileName = fileName;
+    journalFormat = format;
+
+    return Compact();
+}
+
+bool LearningAI::Compact()
+{
+    WaitForWorker();
+
+    // The journal continues the storage file by its checksum, if the new journal
+    // is not created after saving, the old one is not replayed on the new storage file
+    unsigned long long checksum;
+    if (!Write(journalFileName, journalFormat, &checksum)
+            || !journal->Create(StorageJournal::GetFileName(journalFileName), checksum))
+    {
+//         Log("AI", "Compacting storage file \"" + journalFileName + "\" failed.", true, true);
+        journal->Close();
+        return false;
+    }
+
+    return true;
+}
+
+void LearningAI::CloseJournal()
+{
+    WaitForWorker();
+
+    journal->Close();
+    journalFileName.clear();
+}
+
+bool LearningAI::IsJournalOpen()
+{
+    WaitForWorker();
+
+    return journal->IsOpen();
+}
+
+void LearningAI::Replay(std::string fileName, unsigned long long checksum)
+{
+    std::vector<StorageFileRecord> records;
+    if (!StorageJournal::Read(StorageJournal::GetFileName(fileName), checksum, &records))
+    {
+        return;
+    }
+
+    MergeRecords(&records);
+}
+
+void LearningAI::CollectRecords(std::vector<StorageFileRecord>* records)
+{
+    // Collect the steps of the storage file not changed since loading and the steps of the storage
+    records->clear();
+    records->reserve(storageFile->GetNumberOfRecords() + storage->GetSize());
+
+    for (std::size_t index = 0; index < storageFile->GetNumberOfRecords(); ++index)
+    {
+        StorageFileRecord fileRecord = storageFile->GetRecord(index);
+        if (storage->Find(fileRecord.key) == NO_STEP_INDEX)
+        {
+            records->push_back(fileRecord);
+        }
+    }
+
+    for (std::size_t index = 0; index < storage->GetSize(); ++index)
+    {
+        records->push_back(storage->GetRecord(index));
+    }
+}
+
+bool LearningAI::Write(std::string fileName, StorageFormat format, unsigned long long* checksum)
+{
+    std::vector<StorageFileRecord> records;
+    CollectRecords(&records);
+    if (format != StorageFormat::Raw)
+    {
+        StorageFile::Sort(&records);
+    }
+
+    // Write to a temporary file first, the storage file is replaced at once (and can be the mapped one)
+    std::string temporaryFileName = fileName + ".tmp";
+    StorageFileWriter writer;
+    if (!writer.Create(temporaryFileName, format))
     {
-        file.close();
 //         Log("AI", "Opening storage file \"" + fileName + "\" for saving failed.", true, true);
+        std::remove(temporaryFileName.c_str());
         return false;
     }
 
-    std::vector<GameStepElement>::iterator si = storage->begin();
-    while (si != storage->end() && file.good())
+    for (std::vector<StorageFileRecord>::const_iterator ri = records.cbegin(); ri != records.cend(); ++ri)
     {
-        GameStepElement step = (*si);
-        file.write(reinterpret_cast<char*>(&step.state0), sizeof(step.state0));
-        file.write(reinterpret_cast<char*>(&step.state1), sizeof(step.state1));
-        file.write(reinterpret_cast<char*>(&step.state2), sizeof(step.state2));
-        file.write(reinterpret_cast<char*>(&step.changes0), sizeof(step.changes0));
-        file.write(reinterpret_cast<char*>(&step.changes1), sizeof(step.changes1));
-        file.write(reinterpret_cast<char*>(&step.wins), sizeof(step.wins));
-        file.write(reinterpret_cast<char*>(&step.losses), sizeof(step.losses));
+        writer.Write(*ri);
+    }
 
-        ++si;
+    if (!writer.Close())
+    {
+//         Log("AI", "Saving storage file \"" + fileName + "\" failed.", true, true);
+        std::remove(temporaryFileName.c_str());
+        return false;
     }
+    *checksum = writer.GetChecksum();
 
-    // TODO: REMOVE LOGGING
-//     for (std::vector<GameStepElement>::iterator i = storage->begin(); i != storage->end(); ++i)
-//     {
-//         Log("S0", binaryToString((*i).state0));
-//         Log("S1", binaryToString((*i).state1));
-//         Log("S2", binaryToString((*i).state2));
-//     }
+    // The raw storage file is not used in place
+    if (format == StorageFormat::Raw)
+    {
+#ifdef _WIN32
+        std::remove(fileName.c_str());
+#endif
+        if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+        {
+//             Log("AI", "Saving storage file \"" + fileName + "\" failed.", true, true);
+            return false;
+        }
 
-    if (file.fail())
+        return true;
+    }
+
+    // The steps are not looked up while the storage file is replaced
+    std::lock_guard<std::mutex> lock(storageMutex);
+#ifdef _WIN32
+    // A mapped file cannot be replaced on Windows, the storage file is closed first and opened again on failure
+    // (the replaced file is kept aside until the saved one is in place)
+    std::string replacedFileName = fileName + ".old";
+    storageFile->Close();
+    std::remove(replacedFileName.c_str());
+    std::rename(fileName.c_str(), replacedFileName.c_str());
+    if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+    {
+//         Log("AI", "Saving storage file \"" + fileName + "\" failed.", true, true);
+        std::remove(temporaryFileName.c_str());
+        std::rename(replacedFileName.c_str(), fileName.c_str());
+        if (!storageFileName.empty())
+        {
+            storageFile->Open(storageFileName);
+        }
+        return false;
+    }
+    std::remove(replacedFileName.c_str());
+#else
+    // The mapping of the replaced file stays valid, it is used until the saved file is opened
+    if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
     {
 //         Log("AI", "Saving storage file \"" + fileName + "\" failed.", true, true);
+        std::remove(temporaryFileName.c_str());
         return false;
     }
+#endif
+
+    StorageFile* savedFile = new StorageFile;
+    if (!savedFile->Open(fileName))
+    {
+//         Log("AI", "Opening storage file \"" + fileName + "\" failed.", true, true);
+        delete savedFile;
+#ifdef _WIN32
+        if (!storageFileName.empty())
+        {
+            storageFile->Open(storageFileName);
+        }
+#endif
+        return false;
+    }
+
+    // Continue with the saved file as the storage file, the changed steps are in it now
+    delete storageFile;
+    storageFile = savedFile;
+    storageFileName = fileName;
+    storage->Clear();
+    return true;
+}
+
+void LearningAI::SetTablebase(const Tablebase* tablebase)
+{
+    this->tablebase = tablebase;
+}
+
+bool LearningAI::StartBackground(std::string fileName, unsigned long long saveInterval, StorageFormat format)
+{
+    if (worker.joinable())
+    {
+        return false;
+    }
+
+    scheduledFileName = fileName;
+    scheduledSaveInterval = saveInterval;
+    scheduledFormat = format;
+    workerStopping = false;
+    workerSaved = true;
+    worker = std::thread(&LearningAI::RunWorker, this);
+
+    return true;
+}
+
+bool LearningAI::Flush()
+{
+    WaitForWorker();
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    bool saved = workerSaved;
+    workerSaved = true;
+    return saved;
+}
+
+bool LearningAI::StopBackground()
+{
+    if (!worker.joinable())
+    {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        workerStopping = true;
+    }
+    queueCondition.notify_all();
+    worker.join();
+
+    bool saved = workerSaved;
+    workerStopping = false;
+    workerSaved = true;
+    return saved;
+}
+
+bool LearningAI::IsBackgroundRunning()
+{
+    return worker.joinable();
+}
+
+void LearningAI::RunWorker()
+{
+    std::vector<GameStepElement> results;
+    std::vector<std::pair<std::string, StorageFormat>> saves;
+    unsigned long long numOfUnsavedGames = 0;
+    bool unsaved = false;
+    while (true)
+    {
+        unsigned long long numOfGames;
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]()
+            {
+                return !queuedResults.empty() || !queuedSaves.empty() || workerStopping;
+            });
+
+            results.swap(queuedResults);
+            saves.swap(queuedSaves);
+            numOfGames = numOfQueuedGames;
+            numOfQueuedGames = 0;
+            stopping = workerStopping;
+            workerBusy = true;
+        }
+
+        // The results of many games are merged at once
+        if (!results.empty())
+        {
+            MergeSteps(results);
+            results.clear();
+            unsaved = true;
+        }
+        numOfUnsavedGames += numOfGames;
+
+        bool saved = true;
+        for (std::vector<std::pair<std::string, StorageFormat>>::const_iterator si = saves.cbegin();
+                si != saves.cend(); ++si)
+        {
+            saved = SaveStorage(si->first, si->second) && saved;
+            if (si->first == scheduledFileName)
+            {
+                numOfUnsavedGames = 0;
+                unsaved = false;
+            }
+        }
+        saves.clear();
+
+        if (!scheduledFileName.empty() && unsaved && (stopping || numOfUnsavedGames >= scheduledSaveInterval))
+        {
+            saved = SaveStorage(scheduledFileName, scheduledFormat) && saved;
+            numOfUnsavedGames = 0;
+            unsaved = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            workerSaved = workerSaved && saved;
+            workerBusy = false;
+        }
+        queueCondition.notify_all();
+
+        if (stopping)
+        {
+            break;
+        }
+    }
+}
+
+void LearningAI::WaitForWorker()
+{
+    // The worker does not wait for itself (saving with the journal compacts it)
+    if (!worker.joinable() || std::this_thread::get_id() == worker.get_id())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCondition.wait(lock, [this]()
+    {
+        return queuedResults.empty() && queuedSaves.empty() && !workerBusy;
+    });
+}
+
+void LearningAI::ExportRecords(std::vector<StorageFileRecord>* records)
+{
+    WaitForWorker();
+
+    CollectRecords(records);
+    StorageFile::Sort(records);
+}
+
+bool LearningAI::View(const std::vector<StorageFileRecord>* records)
+{
+    WaitForWorker();
+
+    if (!storage->IsEmpty() || storageFile->IsOpen())
+    {
+        return false;
+    }
+
+    storageFile->View(records->data(), records->size());
 
-    file.close();
     return true;
 }
 
+bool LearningAI::ExportBestSteps(BestStepTable* table)
+{
+    std::vector<StorageFileRecord> records;
+    ExportRecords(&records);
+
+    return table->Build(records);
+}
+
+void LearningAI::SetBestStepTable(const BestStepTable* table)
+{
+    bestStepTable = table;
+    history->clear();
+}
+
+void LearningAI::SetExploration(unsigned int exploration)
+{
+    this->exploration = exploration;
+}
+
 std::array<unsigned char, 2> LearningAI::GetNextStep(bool retry)
 {
     if (!retry)
@@ -156,40 +621,148 @@ std::array<unsigned char, 2> LearningAI::GetNextStep(bool retry)
         {
             return { 255, 255 };
         }
-        GameStepElement* nextStepElement = nullptr;
-        std::vector<GameStepElement>::iterator si;
-        for (si = storage->begin(); si != storage->end(); ++si)
+        STATISTICS_COUNT(statistics.numOfLookups);
+
+        // Select the best action of the tablebase
+        GameAction action;
+        if (tablebase != nullptr && tablebase->GetBestAction(game, &action, &random))
+        {
+            STATISTICS_COUNT(statistics.numOfTablebaseHits);
+            currentStep.changes0 = action.from;
+            currentStep.changes1 = action.to;
+            return { currentStep.changes0, currentStep.changes1 };
+        }
+
+        // Select the best step of the table without the storage
+        if (bestStepTable != nullptr)
+        {
+            unsigned char changes0;
+            unsigned char changes1;
+            if (!bestStepTable->Find(GetStateKey(currentStep), &changes0, &changes1))
+            {
+                STATISTICS_COUNT(statistics.numOfMisses);
+                RandomGenerate();
+                return { currentStep.changes0, currentStep.changes1 };
+            }
+
+            STATISTICS_COUNT(statistics.numOfTableHits);
+            unsigned char inverseSymmetry = GetInverseSymmetry(currentSymmetry);
+            currentStep.changes0 = TransformPlace(inverseSymmetry, changes0);
+            currentStep.changes1 = TransformPlace(inverseSymmetry, changes1);
+            return { currentStep.changes0, currentStep.changes1 };
+        }
+
+        // Try a random step instead of the stored ones
+        if (exploration > 0 && random.Next(100) < exploration)
+        {
+            RandomGenerate();
+            return { currentStep.changes0, currentStep.changes1 };
+        }
+
+        // Select the stored step with the best balance (between the changes of the background worker),
+        // the equal balances are decided by the key like in the best step table
+        std::lock_guard<std::mutex> lock(storageMutex);
+        StorageFileRecord nextRecord = {};
+        long long nextBalance = 0;
+        bool hasNextStep = false;
+        unsigned long long stateKey = GetStateKey(currentStep);
+        for (std::size_t index = storage->GetFirst(stateKey); index != NO_STEP_INDEX; index = storage->GetNext(index))
+        {
+            long long balance = storage->GetBalance(index);
+            if (!hasNextStep || nextBalance < balance
+                || (nextBalance == balance && storage->GetKey(index) < nextRecord.key))
+            {
+                nextRecord = storage->GetRecord(index);
+                nextBalance = balance;
+                hasNextStep = true;
+            }
+        }
+
+        // Select from the steps of the storage file not changed since loading
+        std::size_t count;
+        const StorageFileRecord* record = storageFile->Find(stateKey, &count);
+        for (; count > 0; --count, ++record)
         {
-            if ((*si).state0 == currentStep.state0 && (*si).state1 == currentStep.state1 && (*si).state2 == currentStep.state2
-                    && (nextStepElement == nullptr || nextStepElement->balance > (*si).balance))
+            long long balance = GetStepBalance(record->wins, record->losses);
+            if ((!hasNextStep || nextBalance < balance || (nextBalance == balance && record->key < nextRecord.key))
+                && storage->Find(record->key) == NO_STEP_INDEX)
             {
-                nextStepElement = &(*si);
-                // TODO: REMOVE LOGGING
-//                 Log("AI", "Using stored step!");
+                nextRecord = *record;
+                nextBalance = balance;
+                hasNextStep = true;
             }
         }
 
-        if (si == storage->end())
+        if (!hasNextStep)
         {
+            STATISTICS_COUNT(statistics.numOfMisses);
             RandomGenerate();
         }
         else
         {
-            currentStep.changes0 = nextStepElement->changes0;
-            currentStep.changes1 = nextStepElement->changes1;
+            GameStepElement nextStep;
+            RecordToStep(nextRecord, &nextStep);
+            STATISTICS_COUNT(Find(nextStep) != NO_STEP_INDEX ? statistics.numOfStorageHits : statistics.numOfFileHits);
+            // TODO: REMOVE LOGGING
+//             Log("AI", "Using stored step!");
+            unsigned char inverseSymmetry = GetInverseSymmetry(currentSymmetry);
+            currentStep.changes0 = TransformPlace(inverseSymmetry, nextStep.changes0);
+            currentStep.changes1 = TransformPlace(inverseSymmetry, nextStep.changes1);
         }
     }
     else
     {
+        STATISTICS_COUNT(statistics.numOfRetries);
         RandomGenerate();
     }
 
     return { currentStep.changes0, currentStep.changes1 };
 }
 
+bool LearningAI::GetStepResults(GameAction action, unsigned int* wins, unsigned int* losses)
+{
+    Convert(game->GetField());
+
+    GameStepElement step = currentStep;
+    step.changes0 = TransformPlace(currentSymmetry, action.from);
+    step.changes1 = TransformPlace(currentSymmetry, action.to);
+
+    std::lock_guard<std::mutex> lock(storageMutex);
+    std::size_t storedIndex = Find(step);
+    if (storedIndex != NO_STEP_INDEX)
+    {
+        *wins = storage->GetWins(storedIndex);
+        *losses = storage->GetLosses(storedIndex);
+        return true;
+    }
+
+    std::size_t count;
+    const StorageFileRecord* record = storageFile->Find(GetStateKey(step), &count);
+    for (; count > 0; --count, ++record)
+    {
+        GameStepElement fileStep;
+        RecordToStep(*record, &fileStep);
+        if (fileStep.changes0 == step.changes0 && fileStep.changes1 == step.changes1)
+        {
+            *wins = fileStep.wins;
+            *losses = fileStep.losses;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void LearningAI::Register(std::array<unsigned char, 2> changes)
 {
-    history->push_back({ currentStep.state0, currentStep.state1, currentStep.state2, changes[0], changes[1] });
+    // The best step table is not learned
+    if (bestStepTable != nullptr)
+    {
+        return;
+    }
+
+    history->push_back({ currentStep.state0, currentStep.state1, currentStep.state2,
+                         TransformPlace(currentSymmetry, changes[0]), TransformPlace(currentSymmetry, changes[1]) });
 
     // TODO: REMOVE LOGGING
 //     Log("HIST", std::to_string(history->size()));
@@ -203,39 +776,349 @@ void LearningAI::Register(std::array<unsigned char, 2> changes)
 //     }
 }
 
-void LearningAI::Store(bool winner)
+void LearningAI::Store(bool winner, std::vector<GameStepElement>* results)
 {
+    StatisticsTimer timer(&statistics.storeNanoseconds);
+    STATISTICS_COUNT(statistics.numOfStores);
+    STATISTICS_ADD(statistics.numOfStoredSteps, history->size());
+
+    // Queue the results to the background worker
+    if (worker.joinable())
+    {
+        for (std::vector<GameStepElement>::iterator hi = history->begin(); hi != history->end(); ++hi)
+        {
+            SetStepResult(&(*hi), winner);
+        }
+        if (results != nullptr)
+        {
+            results->insert(results->end(), history->begin(), history->end());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queuedResults.insert(queuedResults.end(), history->begin(), history->end());
+            ++numOfQueuedGames;
+        }
+        queueCondition.notify_all();
+
+        history->clear();
+        return;
+    }
+
+    // Collect the results of the steps for the journal
+    std::vector<StorageFileRecord> records;
+    if (journal->IsOpen())
+    {
+        records.reserve(history->size());
+    }
+
     // Loop through the history
     for (std::vector<GameStepElement>::iterator hi = history->begin(); hi != history->end(); ++hi)
     {
-        // Find game step in storage
-        std::vector<GameStepElement>::iterator si;
-        for (si = storage->begin(); si != storage->end(); ++si)
+        if (journal->IsOpen())
         {
-            if ((*si).state0 == (*hi).state0 && (*si).state1 == (*hi).state1 && (*si).state2 == (*hi).state2
-                    && (*si).changes0 == (*hi).changes0 && (*si).changes1 == (*hi).changes1)
-            {
-                break;
-            }
+            GameStepElement result = *hi;
+            SetStepResult(&result, winner);
+            records.push_back(StepToRecord(result));
+        }
+
+        if (results != nullptr)
+        {
+            GameStepElement result = *hi;
+            SetStepResult(&result, winner);
+            results->push_back(result);
         }
 
+        // Find game step in storage
+        std::size_t storedIndex = Fetch(*hi);
+
         // Insert element if not found in storage
-        if (si == storage->end())
+        if (storedIndex == NO_STEP_INDEX)
         {
-            SetStepResult(hi, winner);
-            storage->push_back((*hi));
+            SetStepResult(&(*hi), winner);
+            Insert(*hi);
             continue;
         }
 
         // Set result for step in storage
-        SetStepResult(si, winner);
+        storage->AddResults(storedIndex, winner ? 1 : 0, winner ? 0 : 1);
+    }
+
+    // A failed append closes the journal, the results are kept by the storage only
+    history->clear();
+    journal->Append(records);
+}
+
+void LearningAI::Collect(bool winner, std::vector<GameStepElement>* results)
+{
+    for (std::vector<GameStepElement>::iterator hi = history->begin(); hi != history->end(); ++hi)
+    {
+        SetStepResult(&(*hi), winner);
     }
+    results->insert(results->end(), history->begin(), history->end());
 
     history->clear();
 }
 
+std::size_t LearningAI::GetNumberOfSteps()
+{
+    WaitForWorker();
+
+    // Do not count the steps of the storage file changed since loading twice
+    std::size_t numOfSteps = storage->GetSize();
+    for (std::size_t index = 0; index < storageFile->GetNumberOfRecords(); ++index)
+    {
+        if (storage->Find(storageFile->GetRecord(index).key) == NO_STEP_INDEX)
+        {
+            ++numOfSteps;
+        }
+    }
+
+    return numOfSteps;
+}
+
+void LearningAI::ClearHistory()
+{
+    history->clear();
+}
+
+void LearningAI::Merge(const std::vector<GameStepElement>& steps)
+{
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queuedResults.insert(queuedResults.end(), steps.begin(), steps.end());
+        }
+        queueCondition.notify_all();
+        return;
+    }
+
+    MergeSteps(steps);
+}
+
+void LearningAI::MergeSteps(const std::vector<GameStepElement>& steps)
+{
+    StatisticsTimer timer(&statistics.mergeNanoseconds);
+    STATISTICS_COUNT(statistics.numOfMerges);
+    STATISTICS_ADD(statistics.numOfMergedSteps, steps.size());
+
+    std::vector<StorageFileRecord> records;
+    records.reserve(steps.size());
+    for (std::vector<GameStepElement>::const_iterator si = steps.cbegin(); si != steps.cend(); ++si)
+    {
+        records.push_back(StepToRecord(*si));
+    }
+
+    // The journal gets the aggregated records (a failed append closes it)
+    {
+        std::lock_guard<std::mutex> lock(storageMutex);
+        MergeRecords(&records);
+    }
+    journal->Append(records);
+}
+
+LearningAIStatistics LearningAI::GetStatistics()
+{
+    LearningAIStatistics snapshot;
+#if defined(MORRIS_STATISTICS)
+    // The counters are read without waiting for the background worker, the sizes between its changes
+    snapshot = statistics;
+    {
+        std::lock_guard<std::mutex> lock(storageMutex);
+        snapshot.numOfStorageSteps = storage->GetSize();
+        snapshot.storageMemory = storage->GetMemorySize();
+        snapshot.numOfFileRecords = storageFile->GetNumberOfRecords();
+    }
+    snapshot.historySize = history->size();
+#endif
+
+    return snapshot;
+}
+
+void LearningAI::ResetStatistics()
+{
+    statistics = LearningAIStatistics();
+}
+
+unsigned long long LearningAI::GetStateKey(const GameStepElement& step)
+{
+    return static_cast<unsigned long long>(step.state0) << 32 | static_cast<unsigned long long>(step.state1) << 16
+           | step.state2;
+}
+
+std::size_t LearningAI::Find(const GameStepElement& step)
+{
+    return storage->Find(StorageFile::GetRecordKey(GetStateKey(step), step.changes0, step.changes1));
+}
+
+std::size_t LearningAI::Fetch(const GameStepElement& step)
+{
+    std::size_t storedIndex = Find(step);
+    if (storedIndex != NO_STEP_INDEX)
+    {
+        return storedIndex;
+    }
+
+    // Copy the step from the storage file
+    std::size_t count;
+    const StorageFileRecord* record = storageFile->Find(GetStateKey(step), &count);
+    for (; count > 0; --count, ++record)
+    {
+        GameStepElement fileStep;
+        RecordToStep(*record, &fileStep);
+        if (fileStep.changes0 == step.changes0 && fileStep.changes1 == step.changes1)
+        {
+            return Insert(fileStep);
+        }
+    }
+
+    return NO_STEP_INDEX;
+}
+
+void LearningAI::MergeRecords(std::vector<StorageFileRecord>* records)
+{
+    // The storage is hashed, the records are merged as they are without storage file
+    if (!storageFile->IsOpen())
+    {
+        for (std::vector<StorageFileRecord>::const_iterator ri = records->cbegin(); ri != records->cend(); ++ri)
+        {
+            std::size_t storedIndex = storage->Find(ri->key);
+            if (storedIndex != NO_STEP_INDEX)
+            {
+                storage->AddResults(storedIndex, ri->wins, ri->losses);
+                continue;
+            }
+
+            storage->Insert(ri->key, ri->wins, ri->losses);
+        }
+        return;
+    }
+
+    StorageFile::Sort(records);
+
+    // Add up the results of the same game steps
+    std::size_t numOfRecords = 0;
+    for (std::size_t index = 0; index < records->size(); ++index)
+    {
+        const StorageFileRecord& record = (*records)[index];
+        if (numOfRecords > 0 && (*records)[numOfRecords - 1].key == record.key)
+        {
+            StorageFileRecord& aggregated = (*records)[numOfRecords - 1];
+            aggregated.wins = AddStepCount(aggregated.wins, record.wins);
+            aggregated.losses = AddStepCount(aggregated.losses, record.losses);
+            continue;
+        }
+
+        (*records)[numOfRecords++] = record;
+    }
+    records->resize(numOfRecords);
+
+    // The storage file is sorted too, it is searched from the previous record only
+    // (the new game steps are inserted in the order of their keys)
+    std::size_t fileIndex = 0;
+    for (std::vector<StorageFileRecord>::const_iterator ri = records->cbegin(); ri != records->cend(); ++ri)
+    {
+        std::size_t storedIndex = storage->Find(ri->key);
+        if (storedIndex != NO_STEP_INDEX)
+        {
+            storage->AddResults(storedIndex, ri->wins, ri->losses);
+            continue;
+        }
+
+        fileIndex = storageFile->LowerBound(ri->key, fileIndex);
+        if (fileIndex != storageFile->GetNumberOfRecords())
+        {
+            StorageFileRecord fileRecord = storageFile->GetRecord(fileIndex);
+            if (fileRecord.key == ri->key)
+            {
+                storedIndex = storage->Insert(fileRecord.key, fileRecord.wins, fileRecord.losses);
+                if (storedIndex != NO_STEP_INDEX)
+                {
+                    storage->AddResults(storedIndex, ri->wins, ri->losses);
+                }
+                continue;
+            }
+        }
+
+        storage->Insert(ri->key, ri->wins, ri->losses);
+    }
+}
+
+bool LearningAI::ReadRawRecord(std::istream* file, StorageFileRecord* record, unsigned long long* checksum)
+{
+    if (file->peek() == std::istream::traits_type::eof())
+    {
+        return false;
+    }
+
+    // The counters are 16 bits wide in the raw storage files
+    GameStepElement step;
+    unsigned short wins;
+    unsigned short losses;
+    file->read(reinterpret_cast<char*>(&step.state0), sizeof(step.state0));
+    file->read(reinterpret_cast<char*>(&step.state1), sizeof(step.state1));
+    file->read(reinterpret_cast<char*>(&step.state2), sizeof(step.state2));
+    file->read(reinterpret_cast<char*>(&step.changes0), sizeof(step.changes0));
+    file->read(reinterpret_cast<char*>(&step.changes1), sizeof(step.changes1));
+    file->read(reinterpret_cast<char*>(&wins), sizeof(wins));
+    file->read(reinterpret_cast<char*>(&losses), sizeof(losses));
+    if (file->fail())
+    {
+        return false;
+    }
+    step.wins = wins;
+    step.losses = losses;
+
+    *record = StepToRecord(step);
+    *checksum = StorageFile::CalculateChecksum(record, 1, *checksum);
+
+    // Transform the step to the canonical symmetry (storage files may contain any of them)
+    std::array<unsigned char, NUM_OF_FIELD_PLACES> gameField;
+    Unpack(step, &gameField);
+    unsigned char symmetry = Canonicalize(gameField, &step);
+    step.changes0 = TransformPlace(symmetry, step.changes0);
+    step.changes1 = TransformPlace(symmetry, step.changes1);
+
+    *record = StepToRecord(step);
+    return true;
+}
+
+void LearningAI::RecordToStep(const StorageFileRecord& record, GameStepElement* step)
+{
+    step->state0 = record.key >> 48;
+    step->state1 = record.key >> 32;
+    step->state2 = record.key >> 16;
+    step->changes0 = record.key >> 8;
+    step->changes1 = record.key;
+    step->wins = record.wins;
+    step->losses = record.losses;
+}
+
+StorageFileRecord LearningAI::StepToRecord(const GameStepElement& step)
+{
+    return { StorageFile::GetRecordKey(GetStateKey(step), step.changes0, step.changes1), step.wins, step.losses };
+}
+
+std::size_t LearningAI::Insert(const GameStepElement& step)
+{
+    StorageFileRecord record = StepToRecord(step);
+
+    return storage->Insert(record.key, record.wins, record.losses);
+}
+
 void LearningAI::Convert(std::array<unsigned char, NUM_OF_FIELD_PLACES>* gameField)
 {
+    currentSymmetry = Canonicalize(*gameField, &currentStep);
+
+    currentState[0] = currentStep.state0;
+    currentState[1] = currentStep.state1;
+    currentState[2] = currentStep.state2;
+}
+
+void LearningAI::Pack(const std::array<unsigned char, NUM_OF_FIELD_PLACES>& gameField, GameStepElement* step)
+{
+    std::array<unsigned short, 3> state;
     for (unsigned char part = 0; part < 3; ++part)
     {
         unsigned short value = 0;
@@ -243,42 +1126,99 @@ void LearningAI::Convert(std::array<unsigned char, NUM_OF_FIELD_PLACES>* gameFie
         unsigned char nextSquareStartingPlace = (part + 1) * NUM_OF_SQUARE_PLACES;
         for (unsigned char place = part * NUM_OF_SQUARE_PLACES; place < nextSquareStartingPlace; ++place)
         {
-            value |= gameField->at(place);
+            value |= gameField[place];
             if (place < nextSquareStartingPlace - 1)
             {
                 value <<= 2;
             }
             // TODO: REMOVE LOGGING
-//             Log("P", binaryToString(gameField->at(place)));
+//             Log("P", binaryToString(gameField[place]));
 //             Log("C", binaryToString(value));
         }
 
-        currentState[part] = value;
+        state[part] = value;
         // TODO: REMOVE LOGGING
 //         Log("CONV", binaryToString(value));
     }
 
-    currentStep.state0 = currentState[0];
-    currentStep.state1 = currentState[1];
-    currentStep.state2 = currentState[2];
+    step->state0 = state[0];
+    step->state1 = state[1];
+    step->state2 = state[2];
+}
+
+void LearningAI::Unpack(const GameStepElement& step, std::array<unsigned char, NUM_OF_FIELD_PLACES>* gameField)
+{
+    std::array<unsigned short, 3> state = { step.state0, step.state1, step.state2 };
+    for (unsigned char part = 0; part < 3; ++part)
+    {
+        unsigned short value = state[part];
+
+        // The first place of the part is stored in the highest bits
+        for (unsigned char place = (part + 1) * NUM_OF_SQUARE_PLACES; place-- > part * NUM_OF_SQUARE_PLACES;)
+        {
+            (*gameField)[place] = value & 3;
+            value >>= 2;
+        }
+    }
+}
+
+unsigned char LearningAI::Canonicalize(const std::array<unsigned char, NUM_OF_FIELD_PLACES>& gameField,
+                                       GameStepElement* step)
+{
+    unsigned char canonicalSymmetry = IDENTITY_SYMMETRY;
+    unsigned long long canonicalKey = 0;
+
+    // Select the symmetry with the lowest state key
+    for (unsigned char symmetry = 0; symmetry < NUM_OF_SYMMETRIES; ++symmetry)
+    {
+        std::array<unsigned char, NUM_OF_FIELD_PLACES> transformedField;
+        for (unsigned char place = 0; place < NUM_OF_FIELD_PLACES; ++place)
+        {
+            transformedField[TransformPlace(symmetry, place)] = gameField[place];
+        }
+
+        GameStepElement transformedStep;
+        Pack(transformedField, &transformedStep);
+        unsigned long long key = GetStateKey(transformedStep);
+        if (symmetry == IDENTITY_SYMMETRY || key < canonicalKey)
+        {
+            canonicalSymmetry = symmetry;
+            canonicalKey = key;
+            step->state0 = transformedStep.state0;
+            step->state1 = transformedStep.state1;
+            step->state2 = transformedStep.state2;
+        }
+    }
+
+    return canonicalSymmetry;
 }
 
 void LearningAI::RandomGenerate()
 {
-    currentStep.changes0 = rand() % NUM_OF_FIELD_PLACES;
-    currentStep.changes1 = rand() % NUM_OF_FIELD_PLACES;
+    GameActionList actions;
+    game->GetActions(&actions);
+    if (actions.size == 0)
+    {
+        currentStep.changes0 = NO_PLACE;
+        currentStep.changes1 = NO_PLACE;
+        return;
+    }
+
+    GameAction action = actions.actions[random.Next(actions.size)];
+    currentStep.changes0 = action.from;
+    currentStep.changes1 = action.to;
     // TODO: REMOVE LOGGING
 //     Log("AI", "Try " + std::to_string(currentStep.changes0) + " " + std::to_string(currentStep.changes1));
 }
 
-void LearningAI::SetStepResult(std::vector<GameStepElement>::iterator ei, bool winner)
+void LearningAI::SetStepResult(GameStepElement* step, bool winner)
 {
     if (winner)
     {
-        (*ei).wins++;
+        step->wins = AddStepCount(step->wins, 1);
     }
     else
     {
-        (*ei).losses++;
+        step->losses = AddStepCount(step->losses, 1);
     }
 }
@@ -11,8 +11,23 @@
 #ifndef LEARNING_AI_H
 #define LEARNING_AI_H
 
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BestStepTable.hpp"
 #include "GameStepElement.hpp"
+#include "GameStepStorage.hpp"
 #include "Game.hpp"
+#include "Random.hpp"
+#include "Statistics.hpp"
+#include "StorageFile.hpp"
+#include "StorageJournal.hpp"
+#include "StorageMerge.hpp"
+#include "Tablebase.hpp"
 
 class LearningAI
 {
@@ -24,10 +39,79 @@ private:
     bool spectator;
 
     /** Vector of game steps (history) */
-    std::vector<GameStepElement>* history;
+    std::vector<GameStepElement>* history = nullptr;
+
+    /** Game steps (AI storage) */
+    GameStepStorage* storage = nullptr;
+
+    /** Mapped AI storage file (its game steps are copied to the storage when changed) */
+    StorageFile* storageFile = nullptr;
+
+    /** Filename of the storage file (empty if not open) */
+    std::string storageFileName;
+
+    /** Journal of the storage file to append the results to */
+    StorageJournal* journal = nullptr;
+
+    /** Filename of the storage file of the journal */
+    std::string journalFileName;
+
+    /** Format of the storage file of the journal */
+    StorageFormat journalFormat = StorageFormat::Raw;
+
+    /** Endgame tablebase to play the positions in it with */
+    const Tablebase* tablebase = nullptr;
+
+    /** Best step table to play with instead of the storage (without learning) */
+    const BestStepTable* bestStepTable = nullptr;
+
+    /** Chance of playing a random step instead of the stored ones (percent) */
+    unsigned int exploration = 0;
+
+    /** Random number generator of the untried steps and the tablebase ties */
+    Random random = Random(Random::GetSeed());
+
+    /** Statistics of the AI */
+    LearningAIStatistics statistics;
+
+    /** Mutex of the storage and the storage file (changed by the background worker with it locked) */
+    std::mutex storageMutex;
+
+    /** Background worker applying the results and saving (not running in synchronous mode) */
+    std::thread worker;
+
+    /** Mutex of the queue of the background worker */
+    std::mutex queueMutex;
 
-    /** Vector of game step elements (AI storage) */
-    std::vector<GameStepElement>* storage;
+    /** Condition of the queue getting work, the worker getting idle or stopping */
+    std::condition_variable queueCondition;
+
+    /** Results waiting to be applied by the background worker */
+    std::vector<GameStepElement> queuedResults;
+
+    /** Number of the games of the waiting results */
+    unsigned long long numOfQueuedGames = 0;
+
+    /** Saves waiting for the background worker (filename and format) */
+    std::vector<std::pair<std::string, StorageFormat>> queuedSaves;
+
+    /** The background worker is applying results or saving */
+    bool workerBusy = false;
+
+    /** The background worker is requested to stop */
+    bool workerStopping = false;
+
+    /** The saves of the background worker were successful since the last flush */
+    bool workerSaved = true;
+
+    /** Filename of the AI storage file saved by the background worker on schedule (empty is not saving) */
+    std::string scheduledFileName;
+
+    /** Number of games between the scheduled saves */
+    unsigned long long scheduledSaveInterval = 0;
+
+    /** Format of the AI storage file saved on schedule */
+    StorageFormat scheduledFormat = StorageFormat::Raw;
 
     /** Current game field state */
     std::array<unsigned short, 3> currentState = { 0, 0, 0 };
@@ -35,18 +119,200 @@ private:
     /** Current game step */
     GameStepElement currentStep;
 
+    /** Symmetry transforming the current game field to the canonical one */
+    unsigned char currentSymmetry = 0;
+
     /**
      * Convert game field state to the storage one
      *
+     * The state is stored in the canonical symmetry of the game field,
+     * so the symmetric game fields share their game steps.
+     *
      * @param[in] gameField The game field
      *
      * @return The state of the game field
      */
     void Convert(std::array<unsigned char, NUM_OF_FIELD_PLACES>* gameField);
 
+    /**
+     * Pack game field to the state of a game step
+     *
+     * @param[in] gameField The game field
+     * @param[out] step The game step element to store the state in
+     */
+    static void Pack(const std::array<unsigned char, NUM_OF_FIELD_PLACES>& gameField, GameStepElement* step);
+
+    /**
+     * Unpack the state of a game step to game field
+     *
+     * @param[in] step The game step element
+     * @param[out] gameField The game field to store the state in
+     */
+    static void Unpack(const GameStepElement& step, std::array<unsigned char, NUM_OF_FIELD_PLACES>* gameField);
+
+    /**
+     * Pack game field to the state of a game step in the canonical symmetry
+     *
+     * The canonical symmetry is the one with the lowest state key.
+     *
+     * @param[in] gameField The game field
+     * @param[out] step The game step element to store the canonical state in
+     *
+     * @return The symmetry transforming the game field to the canonical one
+     */
+    static unsigned char Canonicalize(const std::array<unsigned char, NUM_OF_FIELD_PLACES>& gameField,
+                                      GameStepElement* step);
+
+    /**
+     * Get the key of the state of a game step
+     *
+     * @param[in] step The game step element
+     *
+     * @return The packed state of the game field
+     */
+    static unsigned long long GetStateKey(const GameStepElement& step);
+
+    /**
+     * Find game step in storage
+     *
+     * @param[in] step The game step element to find by state and changes
+     *
+     * @return The index of the game step in the storage or NO_STEP_INDEX if not found
+     */
+    std::size_t Find(const GameStepElement& step);
+
+    /**
+     * Fetch game step for update
+     *
+     * Find the game step in the storage
+     * or copy it to the storage from the storage file.
+     *
+     * @param[in] step The game step element to find by state and changes
+     *
+     * @return The index of the game step in the storage or NO_STEP_INDEX if not found
+     */
+    std::size_t Fetch(const GameStepElement& step);
+
+    /**
+     * Merge storage file records into storage
+     *
+     * With storage file the records are sorted and aggregated by key,
+     * then merged into the storage in one pass, looking up the storage
+     * file in key order.
+     *
+     * @param[in,out] records The records to add the wins and losses of (sorted and aggregated with storage file)
+     */
+    void MergeRecords(std::vector<StorageFileRecord>* records);
+
+    /**
+     * Merge results into storage and append them to the journal
+     *
+     * @param[in] steps The game step elements to add the wins and losses of
+     */
+    void MergeSteps(const std::vector<GameStepElement>& steps);
+
+    /**
+     * Read a game step of a raw AI storage file
+     *
+     * @param[in,out] file The file to read from
+     * @param[out] record Pointer to store the game step in the canonical symmetry in
+     * @param[in,out] checksum Pointer to the checksum to continue with the game step as in the file
+     *
+     * @return A game step is read
+     */
+    static bool ReadRawRecord(std::istream* file, StorageFileRecord* record, unsigned long long* checksum);
+
+    /**
+     * Convert storage file record to game step
+     *
+     * @param[in] record The storage file record
+     * @param[out] step The game step element to store the record in
+     */
+    static void RecordToStep(const StorageFileRecord& record, GameStepElement* step);
+
+    /**
+     * Convert game step to storage file record
+     *
+     * @param[in] step The game step element
+     *
+     * @return The storage file record
+     */
+    static StorageFileRecord StepToRecord(const GameStepElement& step);
+
+    /**
+     * Insert game step into storage
+     *
+     * @param[in] step The game step element to insert
+     *
+     * @return The index of the game step in the storage
+     */
+    std::size_t Insert(const GameStepElement& step);
+
+    /**
+     * Replay the journal of a storage file into the storage
+     *
+     * @param[in] fileName Filename of the storage file loaded
+     * @param[in] checksum Checksum of the storage file loaded
+     */
+    void Replay(std::string fileName, unsigned long long checksum);
+
+    /**
+     * Collect the records of the storage and the storage file
+     *
+     * The records of the storage file changed since loading are
+     * collected from the storage only.
+     *
+     * @param[out] records Pointer to store the records in (not sorted)
+     */
+    void CollectRecords(std::vector<StorageFileRecord>* records);
+
+    /**
+     * Write the storage to AI storage file
+     *
+     * The file is written to a temporary file first and replaces the
+     * existing one at once. The storage and the storage file in use are
+     * kept until the written file is opened, so a failed save loses no
+     * steps.
+     *
+     * @param[in] fileName Filename of the AI storage file to write to
+     * @param[in] format Format of the AI storage file
+     * @param[out] checksum Pointer to store the checksum of the written file in
+     *
+     * @return Writing was successful
+     */
+    bool Write(std::string fileName, StorageFormat format, unsigned long long* checksum);
+
+    /**
+     * Save to AI storage file on the current thread
+     *
+     * @param[in] fileName Filename of the AI storage file to save to
+     * @param[in] format Format of the AI storage file
+     *
+     * @return Saving was successful
+     */
+    bool SaveStorage(std::string fileName, StorageFormat format);
+
+    /**
+     * Run the background worker
+     *
+     * Apply the queued results in one merge, then do the queued saves
+     * and the scheduled one, until stopping.
+     */
+    void RunWorker();
+
+    /**
+     * Wait for the background worker to apply the queued results and do the queued saves
+     *
+     * The worker stays idle until new results or saves are queued, so the
+     * storage can be used on the current thread afterwards.
+     */
+    void WaitForWorker();
+
     /**
      * Random generate step change
      *
+     * Select one of the valid actions of the current player.
+     *
      * @return The changes in the field
      */
     void RandomGenerate();
@@ -54,16 +320,26 @@ private:
     /**
      * Set step result
      *
-     * @param[in] ei Game step element iterator
+     * @param[in] step Game step element
      * @param[in] winner Store steps as the game has won by the AI
      */
-    void SetStepResult(std::vector<GameStepElement>::iterator ei, bool winner);
+    static void SetStepResult(GameStepElement* step, bool winner);
 
 public:
 
+    /**
+     * Destruct object
+     *
+     * The background worker is stopped, the storage file and the journal are closed.
+     */
+    ~LearningAI();
+
     /**
      * Initialize object
      *
+     * Initializing again stops the background worker and starts with an
+     * empty storage.
+     *
      * @param[in] game Pointer to the game object
      * @param[in] spectator AI is spectator
      *
@@ -78,33 +354,230 @@ public:
      */
     bool IsSpectator();
 
+    /**
+     * Seed the random number generator
+     *
+     * Seeding the AIs and the games makes the games reproducible.
+     *
+     * @param[in] seed The seed of the generator
+     */
+    void Seed(unsigned long long seed);
+
     /**
      * Load from AI storage file
      *
+     * Mapped storage files are used in place if nothing is loaded yet,
+     * other files are merged into the storage.
+     *
+     * Raw storage files have no header, so the files learned with the
+     * rules before STORAGE_FILE_VERSION 2 (a mill formed again after a
+     * removal did not count) are not recognized and load under the current
+     * rules. Refuse them to load only versioned files, the raw files known
+     * to be current can be converted to mapped ones (see the Merge tool).
+     *
      * @param[in] fileName Filename of the AI storage file to load from
+     * @param[in] raw Load raw storage files too (their version is not checked)
      *
-     * @return Loading was successful
+     * @return Loading was successful (false for a raw storage file if not loading them)
      */
-    bool Load(std::string fileName);
+    bool Load(std::string fileName, bool raw = true);
 
     /**
      * Save to AI storage file
      *
+     * Saving to the storage file of the journal (see OpenJournal) compacts the journal.
+     * In background mode the save is queued (see Flush).
+     *
      * @param[in] fileName Filename of the AI storage file to save to
+     * @param[in] format Format of the AI storage file (the saved mapped or compressed file becomes the used one)
      *
-     * @return Saving was successful
+     * @return Saving was successful (or queued)
+     */
+    bool Save(std::string fileName, StorageFormat format = StorageFormat::Raw);
+
+    /**
+     * Add an AI storage file to a merge
+     *
+     * Mapped storage files are merged in place, the game steps of other
+     * files are transformed to the canonical symmetry, the journal of the
+     * file is added too. The file is not loaded into memory.
+     *
+     * @param[in] fileName Filename of the AI storage file
+     * @param[in,out] merge Pointer to the merge to add the file to
+     *
+     * @return Adding was successful
+     */
+    static bool MergeFile(std::string fileName, StorageMerge* merge);
+
+    /**
+     * Open the journal of an AI storage file
+     *
+     * Load the storage file and its journal if exists, then compact them.
+     * The results of the following games and merges are appended to the
+     * journal, their cost is proportional to the number of steps stored,
+     * not to the size of the storage. A crash loses at most the batch
+     * being appended. A failed append closes the journal (see
+     * IsJournalOpen), the results stay in the storage until compacting or
+     * saving.
+     *
+     * @param[in] fileName Filename of the AI storage file
+     * @param[in] format Format of the AI storage file to compact to
+     *
+     * @return Opening was successful
+     */
+    bool OpenJournal(std::string fileName, StorageFormat format = StorageFormat::Raw);
+
+    /**
+     * Compact the journal into its storage file
+     *
+     * Save the storage to the storage file and start a new empty journal
+     * (the journal closed by a failed append is opened again).
+     *
+     * @return Compacting was successful
+     */
+    bool Compact();
+
+    /**
+     * Close the journal
+     */
+    void CloseJournal();
+
+    /**
+     * Is the journal open?
+     *
+     * @return The journal is open (not closed by a failed append)
+     */
+    bool IsJournalOpen();
+
+    /**
+     * Start the background mode
+     *
+     * The stored and merged results are queued to a background worker,
+     * which applies them to the storage and saves the storage file, so
+     * Store, Merge and Save return without waiting for the storage.
+     * Getting the next step and the results of the steps is served from
+     * the storage meanwhile, between the changes of the worker. The other
+     * operations on the storage wait for the worker first.
+     *
+     * @param[in] fileName Filename of the AI storage file to save to on schedule (empty is not saving)
+     * @param[in] saveInterval The number of stored games between the saves
+     * @param[in] format Format of the AI storage file
+     *
+     * @return Starting was successful (not running already)
+     */
+    bool StartBackground(std::string fileName = "", unsigned long long saveInterval = 10000,
+                         StorageFormat format = StorageFormat::Raw);
+
+    /**
+     * Flush the background worker
+     *
+     * Wait until the queued results are applied and the queued saves are done.
+     *
+     * @return The saves of the worker were successful since the last flush
+     */
+    bool Flush();
+
+    /**
+     * Stop the background mode
+     *
+     * The queued results are applied and the results applied since the
+     * last scheduled save are saved before the worker stops.
+     *
+     * @return The saves of the worker were successful since the last flush
+     */
+    bool StopBackground();
+
+    /**
+     * Is the background mode running?
+     *
+     * @return The background worker is running
+     */
+    bool IsBackgroundRunning();
+
+    /**
+     * Set the endgame tablebase
+     *
+     * The positions in the tablebase are played perfectly instead of by the storage.
+     *
+     * @param[in] tablebase Pointer to the tablebase (nullptr to play without one)
+     */
+    void SetTablebase(const Tablebase* tablebase);
+
+    /**
+     * Export the game steps of the storage
+     *
+     * @param[out] records Pointer to store the records of the game steps in (replaced, sorted by key)
+     */
+    void ExportRecords(std::vector<StorageFileRecord>* records);
+
+    /**
+     * View records as the storage file
+     *
+     * The records are used in place like a mapped storage file, so a
+     * snapshot of a storage (see ExportRecords) can be shared by many
+     * AIs. They must stay valid and unchanged while the AI uses them.
+     *
+     * @param[in] records Pointer to the records sorted by key
+     *
+     * @return Viewing was successful (nothing was loaded yet)
+     */
+    bool View(const std::vector<StorageFileRecord>* records);
+
+    /**
+     * Export the best steps of the storage to a best step table
+     *
+     * @param[out] table Pointer to the table to build
+     *
+     * @return Exporting was successful
+     */
+    bool ExportBestSteps(BestStepTable* table);
+
+    /**
+     * Set the best step table (inference mode)
+     *
+     * The steps are played by the table with a single lookup instead of
+     * the storage, the positions not in the table randomly. The history
+     * is not kept, so the AI does not learn. A table can be shared by
+     * many AIs.
+     *
+     * @param[in] table Pointer to the table (nullptr to play with the storage)
      */
-    bool Save(std::string fileName);
+    void SetBestStepTable(const BestStepTable* table);
+
+    /**
+     * Set the exploration
+     *
+     * The stored steps are always played otherwise, so the other steps of
+     * the known states are never tried (and self play repeats the same
+     * games).
+     *
+     * @param[in] exploration The chance of playing a random step instead of the stored ones (percent)
+     */
+    void SetExploration(unsigned int exploration);
 
     /**
      * Get the next step
      *
+     * The stored step with the best balance is played, the equal balances
+     * are decided by the smaller key like in the best step tables.
+     *
      * @param[in] retry Retry getting valid step
      *
      * @return The changes in the field
      */
     std::array<unsigned char, 2> GetNextStep(bool retry = false);
 
+    /**
+     * Get the stored results of an action in the current position
+     *
+     * @param[in] action The action of the current player
+     * @param[out] wins Pointer to store the number of wins in
+     * @param[out] losses Pointer to store the number of losses in
+     *
+     * @return The action is stored
+     */
+    bool GetStepResults(GameAction action, unsigned int* wins, unsigned int* losses);
+
     /**
      * Register step in history
      *
@@ -115,9 +588,63 @@ public:
     /**
      * Store results in storage
      *
+     * In background mode the results are queued to the worker.
+     *
      * @param[in] winner Store steps as the game has won by the AI
+     * @param[out] results Pointer to the vector to append the results of the steps to
+     */
+    void Store(bool winner, std::vector<GameStepElement>* results = nullptr);
+
+    /**
+     * Collect results without storing them
+     *
+     * The storage is not changed, the results are merged elsewhere (see
+     * Merge), e.g. by the AI trained by self play.
+     *
+     * @param[in] winner Collect steps as the game has won by the AI
+     * @param[out] results Pointer to the vector to append the results of the steps to
+     */
+    void Collect(bool winner, std::vector<GameStepElement>* results);
+
+    /**
+     * Get the number of steps in the storage
+     *
+     * @return The number of steps in the storage and the storage file
+     */
+    std::size_t GetNumberOfSteps();
+
+    /**
+     * Clear the history without storing results
+     */
+    void ClearHistory();
+
+    /**
+     * Merge results into storage
+     *
+     * Batch ingest of the results of many games (see Store). With mapped
+     * storage file the steps are sorted and aggregated by state and
+     * changes, then merged with the storage file in one pass. In background
+     * mode the steps are queued to the worker.
+     *
+     * @param[in] steps The game step elements to add the wins and losses of
+     */
+    void Merge(const std::vector<GameStepElement>& steps);
+
+    /**
+     * Get the statistics
+     *
+     * The counters are collected and the sizes are measured at the call
+     * only with MORRIS_STATISTICS defined. The queued work of the
+     * background worker is not waited for.
+     *
+     * @return The statistics of the AI
+     */
+    LearningAIStatistics GetStatistics();
+
+    /**
+     * Reset the counters of the statistics
      */
-    void Store(bool winner);
+    void ResetStatistics();
 };
 
 #endif // LEARNING_AI_H
@@ -0,0 +1,280 @@
+/**
+ * Monte Carlo AI Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "MonteCarloAI.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+MonteCarloAI::MonteCarloAI() : numOfNodes(0), numOfIterations(0), stopped(false)
+{
+}
+
+bool MonteCarloAI::Initialize(Game* game, unsigned int numOfThreads, std::size_t maxNumOfNodes)
+{
+    this->game = game;
+    if (game == nullptr || maxNumOfNodes <= MAX_NUM_OF_ACTIONS || maxNumOfNodes >= NO_NODE_INDEX)
+    {
+        return false;
+    }
+
+    if (numOfThreads == 0)
+    {
+        numOfThreads = std::thread::hardware_concurrency();
+    }
+    this->numOfThreads = numOfThreads > 0 ? numOfThreads : 1;
+
+    nodes = std::vector<MonteCarloNode>(maxNumOfNodes);
+    Reset();
+
+    return true;
+}
+
+void MonteCarloAI::SetPriors(LearningAI* priors)
+{
+    this->priors = priors;
+}
+
+GameAction MonteCarloAI::GetBestAction(double seconds, unsigned long long maxNumOfIterations)
+{
+    numOfIterations = 0;
+    stopped = false;
+    value = 0;
+    Reset();
+
+    MonteCarloNode& root = nodes[0];
+    if (game->GetGameState() == GameState::End || !Expand(&root, game) || root.numOfChildren == 0)
+    {
+        return { NO_PLACE, NO_PLACE };
+    }
+    if (root.numOfChildren == 1)
+    {
+        return nodes[root.firstChild].action;
+    }
+
+    // Start the actions with their stored results (from the view of the player applied them as the scores)
+    if (priors != nullptr)
+    {
+        for (unsigned int index = root.firstChild; index < root.firstChild + root.numOfChildren; ++index)
+        {
+            unsigned int wins;
+            unsigned int losses;
+            if (!priors->GetStepResults(nodes[index].action, &wins, &losses) || wins + losses == 0)
+            {
+                continue;
+            }
+
+            unsigned long long total = static_cast<unsigned long long>(wins) + losses;
+            unsigned long long priorVisits = total < MONTE_CARLO_MAX_PRIOR_VISITS ? total : MONTE_CARLO_MAX_PRIOR_VISITS;
+            nodes[index].visits = static_cast<unsigned int>(priorVisits);
+            nodes[index].score = (2 * wins * priorVisits + total / 2) / total;
+            root.visits += static_cast<unsigned int>(priorVisits);
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned int index = 0; index < numOfThreads; ++index)
+    {
+        threads.push_back(std::thread(&MonteCarloAI::Run, this, maxNumOfIterations, seconds));
+    }
+    for (std::vector<std::thread>::iterator ti = threads.begin(); ti != threads.end(); ++ti)
+    {
+        ti->join();
+    }
+
+    // Select the most visited action
+    const MonteCarloNode* best = &nodes[root.firstChild];
+    for (unsigned int index = root.firstChild + 1; index < root.firstChild + root.numOfChildren; ++index)
+    {
+        if (nodes[index].visits > best->visits)
+        {
+            best = &nodes[index];
+        }
+    }
+    value = best->visits > 0 ? best->score / (2.0 * best->visits) : 0;
+
+    return best->action;
+}
+
+unsigned long long MonteCarloAI::GetNumberOfIterations()
+{
+    return numOfIterations;
+}
+
+double MonteCarloAI::GetValue()
+{
+    return value;
+}
+
+unsigned int MonteCarloAI::GetNumberOfNodes()
+{
+    return numOfNodes < nodes.size() ? numOfNodes.load() : static_cast<unsigned int>(nodes.size());
+}
+
+void MonteCarloAI::Reset()
+{
+    MonteCarloNode& root = nodes[0];
+    root.action = { NO_PLACE, NO_PLACE };
+    root.player = 0;
+    root.numOfChildren = 0;
+    root.expansion = MonteCarloExpansion::NotExpanded;
+    root.firstChild = NO_NODE_INDEX;
+    root.visits = 0;
+    root.score = 0;
+    numOfNodes = 1;
+}
+
+bool MonteCarloAI::Expand(MonteCarloNode* node, Game* nodeGame)
+{
+    // Leave the node to the thread expanding it, or unexpanded if the tree is full
+    if (numOfNodes.load(std::memory_order_relaxed) >= nodes.size())
+    {
+        return false;
+    }
+    unsigned char expansion = MonteCarloExpansion::NotExpanded;
+    if (!node->expansion.compare_exchange_strong(expansion, MonteCarloExpansion::Expanding))
+    {
+        return false;
+    }
+
+    GameActionList actions;
+    nodeGame->GetActions(&actions);
+    unsigned int firstChild = numOfNodes.fetch_add(actions.size);
+    if (firstChild + actions.size > nodes.size())
+    {
+        node->expansion = MonteCarloExpansion::NotExpanded;
+        return false;
+    }
+
+    unsigned char player = nodeGame->GetCurrentPlayer();
+    for (unsigned char index = 0; index < actions.size; ++index)
+    {
+        MonteCarloNode& child = nodes[firstChild + index];
+        child.action = actions.actions[index];
+        child.player = player;
+        child.numOfChildren = 0;
+        child.expansion.store(MonteCarloExpansion::NotExpanded, std::memory_order_relaxed);
+        child.firstChild = NO_NODE_INDEX;
+        child.visits.store(0, std::memory_order_relaxed);
+        child.score.store(0, std::memory_order_relaxed);
+    }
+
+    // Publish the children with the expansion state
+    node->firstChild = firstChild;
+    node->numOfChildren = actions.size;
+    node->expansion.store(MonteCarloExpansion::Expanded, std::memory_order_release);
+
+    return true;
+}
+
+MonteCarloNode* MonteCarloAI::Select(MonteCarloNode* node)
+{
+    unsigned int parentVisits = node->visits.load(std::memory_order_relaxed);
+    double logVisits = std::log(parentVisits > 1 ? parentVisits : 1);
+
+    MonteCarloNode* best = nullptr;
+    double bestValue = -1;
+    for (unsigned int index = node->firstChild; index < node->firstChild + node->numOfChildren; ++index)
+    {
+        MonteCarloNode* child = &nodes[index];
+        unsigned int visits = child->visits.load(std::memory_order_relaxed);
+        if (visits == 0)
+        {
+            return child;
+        }
+
+        double childValue = child->score.load(std::memory_order_relaxed) / (2.0 * visits)
+                            + MONTE_CARLO_EXPLORATION * std::sqrt(logVisits / visits);
+        if (childValue > bestValue)
+        {
+            best = child;
+            bestValue = childValue;
+        }
+    }
+
+    return best;
+}
+
+unsigned char MonteCarloAI::Rollout(Game* game, Random* random)
+{
+    for (unsigned int step = 0; step < MONTE_CARLO_MAX_ROLLOUT_STEPS; ++step)
+    {
+        // The current player is the winner at the end of the game
+        if (game->GetGameState() == GameState::End)
+        {
+            return game->GetCurrentPlayer();
+        }
+
+        GameActionList actions;
+        game->GetActions(&actions);
+        if (actions.size == 0)
+        {
+            return 0;
+        }
+        game->Apply(actions.actions[random->Next(actions.size)]);
+    }
+
+    return game->GetGameState() == GameState::End ? game->GetCurrentPlayer() : 0;
+}
+
+void MonteCarloAI::Run(unsigned long long maxNumOfIterations, double seconds)
+{
+    Random& random = Random::GetThreadRandom();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+
+    std::vector<MonteCarloNode*> path;
+    while (!stopped.load(std::memory_order_relaxed))
+    {
+        if (std::chrono::steady_clock::now() >= end)
+        {
+            stopped = true;
+            break;
+        }
+        if (numOfIterations.fetch_add(1) >= maxNumOfIterations && maxNumOfIterations != 0)
+        {
+            --numOfIterations;
+            stopped = true;
+            break;
+        }
+
+        // Select the actions by UCT down to a node not expanded (a visit is a loss until it finishes)
+        Game iterationGame = *game;
+        MonteCarloNode* node = &nodes[0];
+        node->visits.fetch_add(1, std::memory_order_relaxed);
+        path.clear();
+        path.push_back(node);
+        while (node->expansion.load(std::memory_order_acquire) == MonteCarloExpansion::Expanded
+                && node->numOfChildren > 0)
+        {
+            node = Select(node);
+            node->visits.fetch_add(1, std::memory_order_relaxed);
+            iterationGame.Apply(node->action);
+            path.push_back(node);
+        }
+
+        // Add a node to the tree
+        if (iterationGame.GetGameState() != GameState::End && Expand(node, &iterationGame) && node->numOfChildren > 0)
+        {
+            node = &nodes[node->firstChild + random.Next(node->numOfChildren)];
+            node->visits.fetch_add(1, std::memory_order_relaxed);
+            iterationGame.Apply(node->action);
+            path.push_back(node);
+        }
+
+        // Finish the visits with the result of the rollout
+        unsigned char winner = Rollout(&iterationGame, &random);
+        for (std::vector<MonteCarloNode*>::iterator pi = path.begin(); pi != path.end(); ++pi)
+        {
+            (*pi)->score.fetch_add(winner == 0 ? 1 : winner == (*pi)->player ? 2 : 0, std::memory_order_relaxed);
+        }
+    }
+}
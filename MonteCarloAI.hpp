@@ -0,0 +1,213 @@
+/**
+ * Monte Carlo AI Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef MONTE_CARLO_AI_H
+#define MONTE_CARLO_AI_H
+
+#include <atomic>
+#include <vector>
+
+#include "Game.hpp"
+#include "LearningAI.hpp"
+#include "Random.hpp"
+
+/** Exploration constant of the UCT selection */
+const double MONTE_CARLO_EXPLORATION = 1.4;
+
+/** Maximum number of steps of a rollout (longer rollouts are draws) */
+const unsigned int MONTE_CARLO_MAX_ROLLOUT_STEPS = 200;
+
+/** Maximum number of visits the stored results of an action count as */
+const unsigned int MONTE_CARLO_MAX_PRIOR_VISITS = 50;
+
+/** Index of no node */
+const unsigned int NO_NODE_INDEX = 0xFFFFFFFF;
+
+/** Expansion state of a node */
+enum MonteCarloExpansion
+{
+    /** Children are not created */
+    NotExpanded,
+
+    /** Children are being created by a thread */
+    Expanding,
+
+    /** Children are created */
+    Expanded
+};
+
+/** Node of the search tree */
+struct MonteCarloNode
+{
+    /** Action leading to the node */
+    GameAction action = { NO_PLACE, NO_PLACE };
+
+    /** Player applied the action */
+    unsigned char player = 0;
+
+    /** Number of children */
+    unsigned char numOfChildren = 0;
+
+    /** Expansion state (MonteCarloExpansion) */
+    std::atomic<unsigned char> expansion;
+
+    /** Index of the first child (the children are consecutive) */
+    unsigned int firstChild = NO_NODE_INDEX;
+
+    /** Number of visits (including the ones in progress) */
+    std::atomic<unsigned int> visits;
+
+    /** Score of the visits finished from the view of the player, in half points (2 for a win, 1 for a draw) */
+    std::atomic<unsigned long long> score;
+};
+
+/**
+ * Monte Carlo tree search AI
+ *
+ * The threads search one shared tree, selecting the actions by UCT,
+ * expanding the tree by a node per iteration and finishing the game
+ * with random actions (rollout). A visit counts as a loss until its
+ * rollout finishes (virtual loss), so the threads spread over the
+ * tree. The actions of the current position may start with the
+ * results stored by a learning AI.
+ */
+class MonteCarloAI
+{
+private:
+    /** Pointer to the game object */
+    Game* game = nullptr;
+
+    /** Learning AI to get the results of the actions of the current position from */
+    LearningAI* priors = nullptr;
+
+    /** Number of threads */
+    unsigned int numOfThreads = 1;
+
+    /** Nodes of the tree (the root is the first) */
+    std::vector<MonteCarloNode> nodes;
+
+    /** Number of nodes used */
+    std::atomic<unsigned int> numOfNodes;
+
+    /** Number of iterations of the last search */
+    std::atomic<unsigned long long> numOfIterations;
+
+    /** Search is stopped */
+    std::atomic<bool> stopped;
+
+    /** Expected score of the best action of the last search */
+    double value = 0;
+
+    /**
+     * Expand a node
+     *
+     * @param[in] node The node to create the children of
+     * @param[in] nodeGame The game in the position of the node
+     *
+     * @return The node is expanded (false if an other thread is expanding it or the tree is full)
+     */
+    bool Expand(MonteCarloNode* node, Game* nodeGame);
+
+    /**
+     * Select the child of a node by UCT
+     *
+     * @param[in] node The expanded node with children
+     *
+     * @return The selected child
+     */
+    MonteCarloNode* Select(MonteCarloNode* node);
+
+    /**
+     * Finish the game with random actions
+     *
+     * @param[in,out] game The game to finish
+     * @param[in,out] random The random number generator to select the actions with
+     *
+     * @return The winner (0 is a draw)
+     */
+    static unsigned char Rollout(Game* game, Random* random);
+
+    /**
+     * Run iterations until stopped
+     *
+     * @param[in] maxNumOfIterations The maximum number of iterations (0 is unlimited)
+     * @param[in] seconds The time budget in seconds
+     */
+    void Run(unsigned long long maxNumOfIterations, double seconds);
+
+    /**
+     * Initialize the tree with the root
+     */
+    void Reset();
+
+public:
+
+    /**
+     * Construct Monte Carlo AI
+     */
+    MonteCarloAI();
+
+    /**
+     * Initialize object
+     *
+     * @param[in] game Pointer to the game object
+     * @param[in] numOfThreads Number of threads (0 is the number of hardware threads)
+     * @param[in] maxNumOfNodes Maximum number of nodes of the tree
+     *
+     * @return Initialization was successful
+     */
+    bool Initialize(Game* game, unsigned int numOfThreads = 0, std::size_t maxNumOfNodes = 1 << 22);
+
+    /**
+     * Set the learning AI to get the priors from
+     *
+     * The actions of the current position start with the results stored
+     * for them (as at most MONTE_CARLO_MAX_PRIOR_VISITS visits).
+     *
+     * @param[in] priors Pointer to the learning AI of the game (nullptr to search without priors)
+     */
+    void SetPriors(LearningAI* priors);
+
+    /**
+     * Get the best action
+     *
+     * Search the game until the time budget or the number of iterations
+     * is used up. The game is not changed by the search.
+     *
+     * @param[in] seconds The time budget in seconds
+     * @param[in] maxNumOfIterations The maximum number of iterations (0 is unlimited)
+     *
+     * @return The most visited action of the current position (NO_PLACE if the game has ended)
+     */
+    GameAction GetBestAction(double seconds, unsigned long long maxNumOfIterations = 0);
+
+    /**
+     * Get the number of iterations of the last search
+     *
+     * @return The number of iterations
+     */
+    unsigned long long GetNumberOfIterations();
+
+    /**
+     * Get the value of the last search
+     *
+     * @return The expected score of the best action from the view of the current player (0 is a loss, 1 is a win)
+     */
+    double GetValue();
+
+    /**
+     * Get the number of nodes of the last search
+     *
+     * @return The number of nodes of the tree
+     */
+    unsigned int GetNumberOfNodes();
+};
+
+#endif // MONTE_CARLO_AI_H
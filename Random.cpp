@@ -0,0 +1,68 @@
+/**
+ * Random Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "Random.hpp"
+
+#include <atomic>
+#include <chrono>
+
+Random::Random(unsigned long long seed)
+{
+    Seed(seed);
+}
+
+void Random::Seed(unsigned long long seed)
+{
+    // Fill the state with SplitMix64 (never all zero)
+    for (unsigned char index = 0; index < 4; ++index)
+    {
+        unsigned long long value = (seed += 0x9E3779B97F4A7C15ull);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        state[index] = value ^ (value >> 31);
+    }
+}
+
+unsigned long long Random::Next()
+{
+    unsigned long long value = state[1] * 5;
+    value = ((value << 7) | (value >> 57)) * 9;
+
+    unsigned long long shifted = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = (state[3] << 45) | (state[3] >> 19);
+
+    return value;
+}
+
+unsigned int Random::Next(unsigned int bound)
+{
+    // Multiply the upper 32 bits with the bound instead of a slow modulo
+    return static_cast<unsigned int>(((Next() >> 32) * bound) >> 32);
+}
+
+unsigned long long Random::GetSeed()
+{
+    static const unsigned long long baseSeed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    static std::atomic<unsigned long long> sequence(0);
+
+    return baseSeed + 0x9E3779B97F4A7C15ull * ++sequence;
+}
+
+Random& Random::GetThreadRandom()
+{
+    thread_local Random random(GetSeed());
+
+    return random;
+}
@@ -0,0 +1,75 @@
+/**
+ * Random Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+/**
+ * Random number generator
+ *
+ * xoshiro256** generator, seeded with SplitMix64.
+ */
+class Random
+{
+private:
+    /** State of the generator */
+    unsigned long long state[4];
+
+public:
+
+    /**
+     * Construct random number generator
+     *
+     * @param[in] seed The seed of the generator
+     */
+    explicit Random(unsigned long long seed);
+
+    /**
+     * Seed the generator
+     *
+     * @param[in] seed The seed of the generator
+     */
+    void Seed(unsigned long long seed);
+
+    /**
+     * Get the next random number
+     *
+     * @return The random number
+     */
+    unsigned long long Next();
+
+    /**
+     * Get the next random number below a bound
+     *
+     * @param[in] bound The bound (must not be 0)
+     *
+     * @return The random number between 0 and bound - 1
+     */
+    unsigned int Next(unsigned int bound);
+
+    /**
+     * Get a new seed
+     *
+     * Different for every call (in every thread), based on the time
+     * of the first call.
+     *
+     * @return The seed
+     */
+    static unsigned long long GetSeed();
+
+    /**
+     * Get the generator of the current thread
+     *
+     * @return The generator of the current thread (seeded with GetSeed)
+     */
+    static Random& GetThreadRandom();
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,447 @@
+/**
+ * Search AI Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "SearchAI.hpp"
+
+#include <thread>
+#include <type_traits>
+
+// The evaluation and the ordering of the actions use the mills of Nine Men's Morris
+static_assert(std::is_same<Game, BasicGame<NineMensMorris>>::value,
+              "The search is implemented for Nine Men's Morris");
+
+/** Values above it (or below its negative) are wins (or losses) */
+const int SEARCH_WIN_BOUND = SEARCH_WIN_VALUE - 4 * MAX_SEARCH_DEPTH;
+
+bool SearchAI::Initialize(Game* game, std::size_t transpositionTableSize)
+{
+    this->game = game;
+    if (game == nullptr || !ownTranspositionTable.Resize(transpositionTableSize))
+    {
+        return false;
+    }
+
+    // The resized table is empty
+    transpositionTable = &ownTranspositionTable;
+    ClearHistory();
+
+    return true;
+}
+
+bool SearchAI::Initialize(Game* game, TranspositionTable* transpositionTable)
+{
+    this->game = game;
+    this->transpositionTable = transpositionTable;
+    if (game == nullptr || transpositionTable == nullptr)
+    {
+        return false;
+    }
+
+    // Keep the entries of the other searches
+    ClearHistory();
+
+    return true;
+}
+
+void SearchAI::SetThreads(unsigned int numOfThreads)
+{
+    if (numOfThreads == 0)
+    {
+        numOfThreads = std::thread::hardware_concurrency();
+    }
+    this->numOfThreads = numOfThreads > 0 ? numOfThreads : 1;
+}
+
+void SearchAI::Clear()
+{
+    transpositionTable->Clear();
+    ClearHistory();
+}
+
+void SearchAI::ClearHistory()
+{
+    for (unsigned char from = 0; from <= NUM_OF_FIELD_PLACES; ++from)
+    {
+        for (unsigned char to = 0; to <= NUM_OF_FIELD_PLACES; ++to)
+        {
+            history[from][to] = 0;
+        }
+    }
+}
+
+void SearchAI::AgeHistory()
+{
+    for (unsigned char from = 0; from <= NUM_OF_FIELD_PLACES; ++from)
+    {
+        for (unsigned char to = 0; to <= NUM_OF_FIELD_PLACES; ++to)
+        {
+            history[from][to] >>= 1;
+        }
+    }
+}
+
+GameAction SearchAI::GetBestAction(unsigned char maxDepth, unsigned long long maxNumOfNodes)
+{
+    this->maxNumOfNodes = maxNumOfNodes;
+    numOfNodes = 0;
+    if (maxDepth > MAX_SEARCH_DEPTH)
+    {
+        maxDepth = MAX_SEARCH_DEPTH;
+    }
+    transpositionTable->NewSearch();
+    AgeHistory();
+
+    // Start the helper threads on copies of the game, every second one a depth ahead
+    std::atomic<bool> helpersStopped(false);
+    std::atomic<unsigned long long> numOfHelperNodes(0);
+    std::vector<std::thread> helpers;
+    for (unsigned int index = 1; index < numOfThreads; ++index)
+    {
+        helpers.push_back(std::thread(&SearchAI::Help, this, *game, 1 + index % 2, maxDepth, &helpersStopped,
+                                      &numOfHelperNodes));
+    }
+
+    GameAction bestAction = Deepen(1, maxDepth);
+
+    helpersStopped = true;
+    for (std::vector<std::thread>::iterator hi = helpers.begin(); hi != helpers.end(); ++hi)
+    {
+        hi->join();
+    }
+    numOfNodes += numOfHelperNodes;
+
+    return bestAction;
+}
+
+void SearchAI::Help(Game game, unsigned char firstDepth, unsigned char maxDepth, const std::atomic<bool>* stopSignal,
+                    std::atomic<unsigned long long>* numOfNodes)
+{
+    SearchAI helper;
+    helper.Initialize(&game, transpositionTable);
+    helper.stopSignal = stopSignal;
+    helper.Deepen(firstDepth, maxDepth);
+
+    *numOfNodes += helper.numOfNodes;
+}
+
+GameAction SearchAI::Deepen(unsigned char firstDepth, unsigned char maxDepth)
+{
+    stopped = false;
+    value = 0;
+    depth = 0;
+
+    // Deepen the search until the limits are reached
+    GameAction bestAction = { NO_PLACE, NO_PLACE };
+    for (unsigned char searchDepth = firstDepth; searchDepth <= maxDepth; ++searchDepth)
+    {
+        GameAction action = { NO_PLACE, NO_PLACE };
+        int searchValue = Search(searchDepth, 0, -SEARCH_WIN_VALUE - 1, SEARCH_WIN_VALUE + 1, &action);
+        if (stopped)
+        {
+            break;
+        }
+
+        bestAction = action;
+        value = searchValue;
+        depth = searchDepth;
+
+        // Stop at a forced win or loss
+        if (value > SEARCH_WIN_BOUND || value < -SEARCH_WIN_BOUND)
+        {
+            break;
+        }
+    }
+
+    return bestAction;
+}
+
+unsigned long long SearchAI::GetNumberOfNodes()
+{
+    return numOfNodes;
+}
+
+int SearchAI::GetValue()
+{
+    return value;
+}
+
+unsigned char SearchAI::GetDepth()
+{
+    return depth;
+}
+
+int SearchAI::Search(unsigned char depth, unsigned char ply, int alpha, int beta, GameAction* bestAction)
+{
+    if ((maxNumOfNodes != 0 && numOfNodes >= maxNumOfNodes)
+            || (stopSignal != nullptr && stopSignal->load(std::memory_order_relaxed)))
+    {
+        stopped = true;
+        return 0;
+    }
+    ++numOfNodes;
+
+    // The current player is the winner at the end of the game
+    if (game->GetGameState() == GameState::End)
+    {
+        return SEARCH_WIN_VALUE - ply;
+    }
+
+    // Probe the transposition table (wins and losses are stored relative to the position)
+    unsigned long long hash = game->GetHash();
+    TranspositionEntry entry;
+    GameAction tableAction = { NO_PLACE, NO_PLACE };
+    if (transpositionTable->Probe(hash, &entry))
+    {
+        tableAction = entry.action;
+
+        int tableValue = entry.value;
+        if (tableValue > SEARCH_WIN_BOUND)
+        {
+            tableValue -= ply;
+        }
+        else if (tableValue < -SEARCH_WIN_BOUND)
+        {
+            tableValue += ply;
+        }
+
+        if (bestAction == nullptr && entry.depth >= depth && (entry.bound == TranspositionBound::Exact
+                || (entry.bound == TranspositionBound::Lower && tableValue >= beta)
+                || (entry.bound == TranspositionBound::Upper && tableValue <= alpha)))
+        {
+            return tableValue;
+        }
+    }
+
+    if (depth == 0 || ply >= MAX_SEARCH_DEPTH)
+    {
+        return Evaluate();
+    }
+
+    GameActionList actions;
+    game->GetActions(&actions);
+    if (actions.size == 0)
+    {
+        return Evaluate();
+    }
+    OrderActions(&actions, tableAction);
+
+    int originalAlpha = alpha;
+    int bestValue = -SEARCH_WIN_VALUE - 1;
+    GameAction best = actions.actions[0];
+    for (unsigned char index = 0; index < actions.size; ++index)
+    {
+        unsigned char player = game->GetCurrentPlayer();
+        GameUndo undo;
+        game->Apply(actions.actions[index], &undo);
+        bool samePlayer = game->GetCurrentPlayer() == player;
+
+        // Search the first action with full window, the rest with null window (and again if better)
+        int actionValue;
+        if (index == 0)
+        {
+            actionValue = SearchAction(samePlayer, depth, ply + 1, alpha, beta);
+        }
+        else
+        {
+            actionValue = SearchAction(samePlayer, depth, ply + 1, alpha, alpha + 1);
+            if (actionValue > alpha && actionValue < beta)
+            {
+                actionValue = SearchAction(samePlayer, depth, ply + 1, alpha, beta);
+            }
+        }
+        game->Undo(undo);
+
+        if (stopped)
+        {
+            return 0;
+        }
+
+        if (actionValue > bestValue)
+        {
+            bestValue = actionValue;
+            best = actions.actions[index];
+        }
+        if (bestValue > alpha)
+        {
+            alpha = bestValue;
+        }
+        if (alpha >= beta)
+        {
+            // The history saturates instead of wrapping
+            unsigned int& bestHistory = history[best.from == NO_PLACE ? NUM_OF_FIELD_PLACES : best.from]
+                                        [best.to == NO_PLACE ? NUM_OF_FIELD_PLACES : best.to];
+            bestHistory = bestHistory < MAX_SEARCH_HISTORY - depth * depth ? bestHistory + depth * depth
+                          : MAX_SEARCH_HISTORY;
+            break;
+        }
+    }
+
+    // Store the result in the transposition table
+    entry.value = bestValue > SEARCH_WIN_BOUND ? bestValue + ply : bestValue < -SEARCH_WIN_BOUND ? bestValue - ply : bestValue;
+    entry.depth = depth;
+    entry.bound = bestValue <= originalAlpha ? TranspositionBound::Upper : bestValue >= beta ? TranspositionBound::Lower :
+                  TranspositionBound::Exact;
+    entry.action = best;
+    transpositionTable->Store(hash, entry);
+
+    if (bestAction != nullptr)
+    {
+        *bestAction = best;
+    }
+
+    return bestValue;
+}
+
+int SearchAI::SearchAction(bool samePlayer, unsigned char depth, unsigned char ply, int alpha, int beta)
+{
+    // Continue with the same depth if the current player has to remove a piece
+    if (samePlayer)
+    {
+        return Search(depth, ply, alpha, beta);
+    }
+
+    return -Search(depth - 1, ply, -beta, -alpha);
+}
+
+int SearchAI::Evaluate()
+{
+    unsigned char player = game->GetCurrentPlayer();
+    unsigned char opponent = NUM_OF_PLAYERS + 1 - player;
+
+    // Pieces on the board and in the decks
+    int value = 100 * (game->GetNumberOfPieces(player) + game->GetDeck(player) - game->GetNumberOfPieces(opponent)
+                       - game->GetDeck(opponent));
+
+    // Pieces to remove after mills
+    if (game->GetGameState() == GameState::Remove)
+    {
+        value += 100 * game->GetNumberOfMills();
+    }
+
+    // Mills to form with one more piece
+    value += 20 * (CountOpenMills(player) - CountOpenMills(opponent));
+
+    // Mobility of the players not able to jump
+    if (game->GetGameState() == GameState::Move)
+    {
+        Bitboard emptyPlaces = FULL_BOARD & ~(game->GetPieces(player) | game->GetPieces(opponent));
+        for (unsigned char index = 1; index <= NUM_OF_PLAYERS; ++index)
+        {
+            if (game->GetNumberOfPieces(index) <= 3)
+            {
+                continue;
+            }
+
+            int mobility = 0;
+            Bitboard playerPieces = game->GetPieces(index);
+            while (playerPieces != 0)
+            {
+                mobility += CountPlaces(NineMensMorris::GetAdjacentMask(PopPlace(&playerPieces)) & emptyPlaces);
+            }
+            value += index == player ? 5 * mobility : -5 * mobility;
+        }
+    }
+
+    return value;
+}
+
+void SearchAI::OrderActions(GameActionList* actions, GameAction firstAction)
+{
+    unsigned char player = game->GetCurrentPlayer();
+    unsigned char opponent = NUM_OF_PLAYERS + 1 - player;
+    Bitboard playerPieces = game->GetPieces(player);
+    Bitboard opponentPieces = game->GetPieces(opponent);
+
+    int scores[MAX_NUM_OF_ACTIONS];
+    for (unsigned char index = 0; index < actions->size; ++index)
+    {
+        GameAction action = actions->actions[index];
+        int score = 0;
+        if (action.from == firstAction.from && action.to == firstAction.to)
+        {
+            score = 1 << 30;
+        }
+        else if (action.to != NO_PLACE)
+        {
+            Bitboard newPieces = playerPieces | GetPlaceMask(action.to);
+            if (action.from != NO_PLACE)
+            {
+                newPieces &= ~GetPlaceMask(action.from);
+            }
+
+            for (MillSet placeMills = GetPlaceMills<NineMensMorris>(action.to); placeMills != 0;)
+            {
+                Bitboard millMask = NineMensMorris::GetMillMask(PopPlace(&placeMills));
+
+                // Closing own mill
+                if ((newPieces & millMask) == millMask)
+                {
+                    score += 2 << 20;
+                }
+                // Blocking opponent's mill
+                else if (CountPlaces(opponentPieces & millMask) == 2)
+                {
+                    score += 1 << 20;
+                }
+            }
+        }
+        else
+        {
+            // Removing pieces of opponent's open mills
+            for (MillSet placeMills = GetPlaceMills<NineMensMorris>(action.from); placeMills != 0;)
+            {
+                Bitboard millMask = NineMensMorris::GetMillMask(PopPlace(&placeMills));
+                if (CountPlaces(opponentPieces & millMask) == 2 && !(playerPieces & millMask))
+                {
+                    score += 1 << 20;
+                }
+            }
+        }
+
+        // Order the rest by the history of the cutoffs
+        unsigned int actionHistory = history[action.from == NO_PLACE ? NUM_OF_FIELD_PLACES : action.from]
+                                     [action.to == NO_PLACE ? NUM_OF_FIELD_PLACES : action.to];
+        scores[index] = score + static_cast<int>(actionHistory);
+    }
+
+    // Sort the actions by the scores (stable insertion sort, the lists are short)
+    for (unsigned char index = 1; index < actions->size; ++index)
+    {
+        GameAction action = actions->actions[index];
+        int score = scores[index];
+        unsigned char position = index;
+        while (position > 0 && scores[position - 1] < score)
+        {
+            actions->actions[position] = actions->actions[position - 1];
+            scores[position] = scores[position - 1];
+            --position;
+        }
+        actions->actions[position] = action;
+        scores[position] = score;
+    }
+}
+
+unsigned char SearchAI::CountOpenMills(unsigned char player)
+{
+    Bitboard playerPieces = game->GetPieces(player);
+    Bitboard emptyPlaces = FULL_BOARD & ~(playerPieces | game->GetPieces(NUM_OF_PLAYERS + 1 - player));
+
+    unsigned char count = 0;
+    for (unsigned char mill = 0; mill < NineMensMorris::NUM_OF_MILLS; ++mill)
+    {
+        Bitboard millMask = NineMensMorris::GetMillMask(mill);
+        if (CountPlaces(playerPieces & millMask) == 2 && (emptyPlaces & millMask))
+        {
+            ++count;
+        }
+    }
+
+    return count;
+}
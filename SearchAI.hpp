@@ -0,0 +1,230 @@
+/**
+ * Search AI Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef SEARCH_AI_H
+#define SEARCH_AI_H
+
+#include <atomic>
+#include <vector>
+
+#include "Game.hpp"
+#include "TranspositionTable.hpp"
+
+/** Value of a won game (decreased by the number of steps to the win) */
+const int SEARCH_WIN_VALUE = 30000;
+
+/** Maximum depth of the search */
+const unsigned char MAX_SEARCH_DEPTH = 64;
+
+/** Maximum value of the history of an action (the ordering scores of the history stay below the mill scores) */
+const unsigned int MAX_SEARCH_HISTORY = (1u << 20) - 1;
+
+class SearchAI
+{
+private:
+    /** Pointer to the game object */
+    Game* game = nullptr;
+
+    /** Transposition table (the own one or a shared one) */
+    TranspositionTable* transpositionTable = nullptr;
+
+    /** Own transposition table */
+    TranspositionTable ownTranspositionTable;
+
+    /** Number of threads */
+    unsigned int numOfThreads = 1;
+
+    /** Signal to stop the search (of the helper threads) */
+    const std::atomic<bool>* stopSignal = nullptr;
+
+    /** History of the actions causing cutoffs (indexed by the from and to places, NO_PLACE is the last) */
+    unsigned int history[NUM_OF_FIELD_PLACES + 1][NUM_OF_FIELD_PLACES + 1];
+
+    /** Number of searched nodes */
+    unsigned long long numOfNodes = 0;
+
+    /** Maximum number of nodes to search (0 is unlimited) */
+    unsigned long long maxNumOfNodes = 0;
+
+    /** Search is stopped by the node limit */
+    bool stopped = false;
+
+    /** Value of the best action of the last search */
+    int value = 0;
+
+    /** Completed depth of the last search */
+    unsigned char depth = 0;
+
+    /**
+     * Deepen the search iteratively
+     *
+     * @param[in] firstDepth The depth to search to first
+     * @param[in] maxDepth The maximum depth to search to
+     *
+     * @return The best action of the deepest completed search
+     */
+    GameAction Deepen(unsigned char firstDepth, unsigned char maxDepth);
+
+    /**
+     * Search as a helper thread until the stop signal
+     *
+     * @param[in] game The game to search (copy of the searched one)
+     * @param[in] firstDepth The depth to search to first
+     * @param[in] maxDepth The maximum depth to search to
+     * @param[in] stopSignal The signal to stop the search
+     * @param[out] numOfNodes Pointer to add the number of searched nodes to
+     */
+    void Help(Game game, unsigned char firstDepth, unsigned char maxDepth, const std::atomic<bool>* stopSignal,
+              std::atomic<unsigned long long>* numOfNodes);
+
+    /**
+     * Clear the history
+     */
+    void ClearHistory();
+
+    /**
+     * Age the history
+     *
+     * The values are halved, so the cutoffs of the recent searches
+     * order the actions the most.
+     */
+    void AgeHistory();
+
+    /**
+     * Search the position of the game
+     *
+     * Negamax search with alpha-beta pruning. The value is
+     * from the view of the current player. Actions not changing the
+     * current player (removals after mills) do not decrease the depth.
+     *
+     * @param[in] depth The depth to search to
+     * @param[in] ply The number of steps from the root
+     * @param[in] alpha The lower bound of the value
+     * @param[in] beta The upper bound of the value
+     * @param[out] bestAction Pointer to store the best action in
+     *
+     * @return The value of the position
+     */
+    int Search(unsigned char depth, unsigned char ply, int alpha, int beta, GameAction* bestAction = nullptr);
+
+    /**
+     * Search the position after an action
+     *
+     * @param[in] samePlayer The action did not change the current player
+     * @param[in] depth The depth of the position before the action
+     * @param[in] ply The number of steps from the root after the action
+     * @param[in] alpha The lower bound of the value
+     * @param[in] beta The upper bound of the value
+     *
+     * @return The value of the position from the view of the player applied the action
+     */
+    int SearchAction(bool samePlayer, unsigned char depth, unsigned char ply, int alpha, int beta);
+
+    /**
+     * Evaluate the position of the game
+     *
+     * @return The value of the position from the view of the current player
+     */
+    int Evaluate();
+
+    /**
+     * Order the actions
+     *
+     * Put the action of the transposition table first, the ones
+     * closing or blocking mills after it and the rest by history.
+     *
+     * @param[in,out] actions The actions to order
+     * @param[in] firstAction The action to put first
+     */
+    void OrderActions(GameActionList* actions, GameAction firstAction);
+
+    /**
+     * Count the places a player could form mills with one more piece
+     *
+     * @param[in] player The player (1 or 2)
+     *
+     * @return The number of the places
+     */
+    unsigned char CountOpenMills(unsigned char player);
+
+public:
+
+    /**
+     * Initialize object
+     *
+     * @param[in] game Pointer to the game object
+     * @param[in] transpositionTableSize Memory size of the transposition table in megabytes
+     *
+     * @return Initialization was successful
+     */
+    bool Initialize(Game* game, std::size_t transpositionTableSize = 16);
+
+    /**
+     * Initialize object with a shared transposition table
+     *
+     * @param[in] game Pointer to the game object
+     * @param[in] transpositionTable Pointer to the transposition table shared with other searches
+     *
+     * @return Initialization was successful
+     */
+    bool Initialize(Game* game, TranspositionTable* transpositionTable);
+
+    /**
+     * Set the number of threads
+     *
+     * The helper threads search copies of the game to various depths
+     * (Lazy SMP), filling the shared transposition table for the
+     * search of the calling thread.
+     *
+     * @param[in] numOfThreads Number of threads (0 is the number of hardware threads)
+     */
+    void SetThreads(unsigned int numOfThreads);
+
+    /**
+     * Clear the transposition table and the history
+     */
+    void Clear();
+
+    /**
+     * Get the best action
+     *
+     * Search the game with iterative deepening. The game
+     * is restored to the current position after the search.
+     *
+     * @param[in] maxDepth The maximum depth to search to
+     * @param[in] maxNumOfNodes The maximum number of nodes to search (0 is unlimited)
+     *
+     * @return The best action of the deepest completed search
+     */
+    GameAction GetBestAction(unsigned char maxDepth, unsigned long long maxNumOfNodes = 0);
+
+    /**
+     * Get the number of nodes of the last search
+     *
+     * @return The number of searched nodes (by every thread)
+     */
+    unsigned long long GetNumberOfNodes();
+
+    /**
+     * Get the value of the last search
+     *
+     * @return The value of the best action from the view of the current player
+     */
+    int GetValue();
+
+    /**
+     * Get the depth of the last search
+     *
+     * @return The depth of the deepest completed search
+     */
+    unsigned char GetDepth();
+};
+
+#endif // SEARCH_AI_H
@@ -0,0 +1,261 @@
+/**
+ * Self Play Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "SelfPlay.hpp"
+
+#include <chrono>
+#include <thread>
+
+SelfPlay::SelfPlay() : seed(Random::GetSeed()), numOfStartedGames(0)
+{
+}
+
+bool SelfPlay::Initialize(LearningAI* ai, unsigned int numOfThreads)
+{
+    this->ai = ai;
+    if (ai == nullptr)
+    {
+        return false;
+    }
+
+    if (numOfThreads == 0)
+    {
+        numOfThreads = std::thread::hardware_concurrency();
+    }
+    this->numOfThreads = numOfThreads > 0 ? numOfThreads : 1;
+
+    return true;
+}
+
+void SelfPlay::SetReporter(std::function<void(unsigned long long, double)> reporter)
+{
+    this->reporter = reporter;
+}
+
+void SelfPlay::Seed(unsigned long long seed)
+{
+    this->seed = seed;
+}
+
+bool SelfPlay::Run(unsigned long long maxNumOfGames, std::string fileName, unsigned long long saveInterval,
+                   StorageFormat format)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    numOfStartedGames = 0;
+    numOfGames = 0;
+    numOfRunningThreads = numOfThreads;
+
+    // The threads play with the mapped or compressed storage file saved last (the raw one is not mapped),
+    // or with the records of the storage exported at the same number of games
+    viewFileName = format != StorageFormat::Raw ? fileName : "";
+    viewInterval = saveInterval > 0 ? saveInterval : 1;
+    numOfViews = 0;
+    bool saved = UpdateView(viewFileName, format);
+
+    std::vector<std::thread> threads;
+    for (unsigned int index = 0; index < numOfThreads; ++index)
+    {
+        threads.push_back(std::thread(&SelfPlay::Play, this, maxNumOfGames, seed + index));
+    }
+
+    // Merge the results handed over until the threads finish
+    unsigned long long mergedNumOfGames = 0;
+    std::vector<GameStepElement> mergedResults;
+    while (true)
+    {
+        bool finished;
+        {
+            std::unique_lock<std::mutex> lock(resultsMutex);
+            resultsCondition.wait(lock, [this, mergedNumOfGames]()
+            {
+                return !results.empty() || numOfGames != mergedNumOfGames || numOfRunningThreads == 0;
+            });
+
+            mergedResults.swap(results);
+            mergedNumOfGames = numOfGames;
+            finished = numOfRunningThreads == 0;
+        }
+
+        ai->Merge(mergedResults);
+        mergedResults.clear();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        gamesPerSecond = seconds > 0 ? mergedNumOfGames / seconds : 0;
+        if (reporter)
+        {
+            reporter(mergedNumOfGames, gamesPerSecond);
+        }
+
+        if (finished)
+        {
+            if (!fileName.empty() && !ai->Save(fileName, format))
+            {
+                saved = false;
+            }
+            break;
+        }
+
+        // Update the view when the games before it are all merged (the following games wait for it)
+        if (mergedNumOfGames >= numOfViews * viewInterval && mergedNumOfGames < maxNumOfGames)
+        {
+            saved = UpdateView(fileName, format) && saved;
+        }
+    }
+
+    for (std::vector<std::thread>::iterator ti = threads.begin(); ti != threads.end(); ++ti)
+    {
+        ti->join();
+    }
+
+    return saved;
+}
+
+unsigned long long SelfPlay::GetNumberOfGames()
+{
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    return numOfGames;
+}
+
+double SelfPlay::GetGamesPerSecond()
+{
+    return gamesPerSecond;
+}
+
+void SelfPlay::Play(unsigned long long maxNumOfGames, unsigned long long threadSeed)
+{
+    Random random(threadSeed);
+    Game game(&random);
+    LearningAI ais[NUM_OF_PLAYERS];
+    for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+    {
+        ais[index].Initialize(&game);
+        ais[index].Seed(random.Next());
+        ais[index].SetExploration(SELF_PLAY_EXPLORATION);
+    }
+
+    std::vector<GameStepElement> threadResults;
+    unsigned long long threadNumOfGames = 0;
+    unsigned long long threadNumOfViews = 0;
+    unsigned long long gameIndex;
+    while ((gameIndex = numOfStartedGames.fetch_add(1)) < maxNumOfGames)
+    {
+        // Play with the view updated after the games before the last multiple of the interval
+        // (the AIs have no storage of their own), so a single thread plays the same games on every run
+        unsigned long long gameNumOfViews = gameIndex / viewInterval + 1;
+        if (gameNumOfViews != threadNumOfViews)
+        {
+            // The view is updated after the results of the games before it are merged
+            HandOver(&threadResults, threadNumOfGames, false);
+            threadNumOfGames = 0;
+            {
+                std::unique_lock<std::mutex> lock(resultsMutex);
+                viewCondition.wait(lock, [this, gameNumOfViews]()
+                {
+                    return numOfViews >= gameNumOfViews;
+                });
+            }
+
+            for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+            {
+                ais[index].Initialize(&game);
+                if (viewFileName.empty())
+                {
+                    ais[index].View(&viewRecords);
+                }
+                else
+                {
+                    ais[index].Load(viewFileName);
+                }
+            }
+            threadNumOfViews = gameNumOfViews;
+        }
+
+        game = Game(&random);
+
+        // Play the game
+        unsigned int numOfSteps = 0;
+        while (game.GetGameState() != GameState::End && numOfSteps < SELF_PLAY_MAX_NUM_OF_STEPS)
+        {
+            LearningAI& ai = ais[game.GetCurrentPlayer() - 1];
+            std::array<unsigned char, 2> changes = ai.GetNextStep();
+            if (!game.Apply({ changes[0], changes[1] }))
+            {
+                changes = ai.GetNextStep(true);
+                if (!game.Apply({ changes[0], changes[1] }))
+                {
+                    break;
+                }
+            }
+
+            ai.Register(changes);
+            ++numOfSteps;
+        }
+
+        // Hand over the results of the finished games only
+        for (unsigned char index = 0; index < NUM_OF_PLAYERS; ++index)
+        {
+            if (game.GetGameState() == GameState::End)
+            {
+                ais[index].Collect(game.GetCurrentPlayer() == index + 1, &threadResults);
+            }
+            else
+            {
+                ais[index].ClearHistory();
+            }
+        }
+
+        if (++threadNumOfGames >= SELF_PLAY_MERGE_INTERVAL)
+        {
+            HandOver(&threadResults, threadNumOfGames, false);
+            threadNumOfGames = 0;
+        }
+    }
+
+    HandOver(&threadResults, threadNumOfGames, true);
+}
+
+void SelfPlay::HandOver(std::vector<GameStepElement>* threadResults, unsigned long long threadNumOfGames,
+                        bool finished)
+{
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results.insert(results.end(), threadResults->begin(), threadResults->end());
+        numOfGames += threadNumOfGames;
+        if (finished)
+        {
+            --numOfRunningThreads;
+        }
+    }
+    resultsCondition.notify_one();
+
+    threadResults->clear();
+}
+
+bool SelfPlay::UpdateView(std::string fileName, StorageFormat format)
+{
+    // The threads use the view only after the background worker of the AI saved it
+    bool saved = true;
+    if (!fileName.empty())
+    {
+        saved = ai->Save(fileName, format) && (!ai->IsBackgroundRunning() || ai->Flush());
+    }
+    if (viewFileName.empty())
+    {
+        ai->ExportRecords(&viewRecords);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        ++numOfViews;
+    }
+    viewCondition.notify_all();
+
+    return saved;
+}
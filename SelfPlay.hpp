@@ -0,0 +1,191 @@
+/**
+ * Self Play Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LearningAI.hpp"
+
+/** Number of games a thread plays before handing over the results */
+const unsigned int SELF_PLAY_MERGE_INTERVAL = 100;
+
+/** Maximum number of steps of a game (results of longer games are not stored) */
+const unsigned int SELF_PLAY_MAX_NUM_OF_STEPS = 1000;
+
+/** Chance of the AIs of the threads playing a random step instead of the stored ones (percent) */
+const unsigned int SELF_PLAY_EXPLORATION = 10;
+
+/**
+ * Self play training
+ *
+ * Every thread plays games between its own pair of learning AIs and
+ * hands over the results of the games periodically. The results are
+ * merged into the storage of the trained AI, which is saved
+ * periodically. The AIs of the threads do not store the results, they
+ * play with a view of the storage of the trained AI: the mapped or
+ * compressed storage file saved last, or the records of the storage
+ * exported at the same time otherwise. Both are shared by the threads,
+ * so the memory of the threads does not grow with the storage.
+ *
+ * The view is updated at fixed numbers of games, the games from the
+ * view update on wait until the games before it are merged.
+ */
+class SelfPlay
+{
+private:
+    /** Pointer to the trained AI */
+    LearningAI* ai = nullptr;
+
+    /** Number of threads */
+    unsigned int numOfThreads = 1;
+
+    /** Seed of the games (the threads use the following seeds) */
+    unsigned long long seed;
+
+    /** Function to report the progress with */
+    std::function<void(unsigned long long, double)> reporter;
+
+    /** Results of the games waiting to be merged */
+    std::vector<GameStepElement> results;
+
+    /** Mutex of the results */
+    std::mutex resultsMutex;
+
+    /** Condition of results waiting or threads finishing */
+    std::condition_variable resultsCondition;
+
+    /** Number of the games started */
+    std::atomic<unsigned long long> numOfStartedGames;
+
+    /** Number of the games handed over */
+    unsigned long long numOfGames = 0;
+
+    /** Number of the running threads */
+    unsigned int numOfRunningThreads = 0;
+
+    /** Number of games played per second */
+    double gamesPerSecond = 0;
+
+    /** Filename of the AI storage file the threads play with (empty is playing with the view records) */
+    std::string viewFileName;
+
+    /** Records of the storage of the trained AI the threads play with (if there is no file to play with) */
+    std::vector<StorageFileRecord> viewRecords;
+
+    /** Number of games between the updates of the view */
+    unsigned long long viewInterval = 1;
+
+    /** Number of the updates of the view (the games from the index viewInterval * n on wait for n + 1 updates) */
+    unsigned long long numOfViews = 0;
+
+    /** Condition of the view updated */
+    std::condition_variable viewCondition;
+
+    /**
+     * Play games in a thread
+     *
+     * @param[in] maxNumOfGames The number of games to play by all the threads
+     * @param[in] threadSeed The seed of the games and the AIs of the thread
+     */
+    void Play(unsigned long long maxNumOfGames, unsigned long long threadSeed);
+
+    /**
+     * Hand over results
+     *
+     * @param[in,out] threadResults The results of the thread (cleared)
+     * @param[in] threadNumOfGames The number of games of the results
+     * @param[in] finished The thread is finished
+     */
+    void HandOver(std::vector<GameStepElement>* threadResults, unsigned long long threadNumOfGames, bool finished);
+
+    /**
+     * Update the view of the storage of the trained AI for the threads
+     *
+     * @param[in] fileName Filename of the AI storage file to save to (empty is not saving)
+     * @param[in] format Format of the AI storage file
+     *
+     * @return Saving was successful (or not saving)
+     */
+    bool UpdateView(std::string fileName, StorageFormat format);
+
+public:
+
+    /**
+     * Construct self play
+     */
+    SelfPlay();
+
+    /**
+     * Initialize object
+     *
+     * @param[in] ai Pointer to the initialized AI to train
+     * @param[in] numOfThreads Number of threads (0 is the number of hardware threads)
+     *
+     * @return Initialization was successful
+     */
+    bool Initialize(LearningAI* ai, unsigned int numOfThreads = 0);
+
+    /**
+     * Set the reporter
+     *
+     * @param[in] reporter Function called with the number of games and the games per second after merges
+     */
+    void SetReporter(std::function<void(unsigned long long, double)> reporter);
+
+    /**
+     * Seed the games
+     *
+     * Every thread plays with its own generator seeded from the seed,
+     * a single thread plays the same games on every run.
+     *
+     * @param[in] seed The seed of the games (random by default)
+     */
+    void Seed(unsigned long long seed);
+
+    /**
+     * Run the training
+     *
+     * Saving in mapped or compressed format saves the AI at the start too,
+     * the threads play with the saved file. With the raw format (or not
+     * saving) the threads play with the exported records of the storage.
+     *
+     * @param[in] maxNumOfGames The number of games to play
+     * @param[in] fileName Filename of the AI storage file to save to (empty is not saving)
+     * @param[in] saveInterval The number of games between the saves and the updates of the view of the threads
+     * @param[in] format Format of the AI storage file
+     *
+     * @return Saving was successful (or not saving)
+     */
+    bool Run(unsigned long long maxNumOfGames, std::string fileName = "", unsigned long long saveInterval = 10000,
+             StorageFormat format = StorageFormat::Raw);
+
+    /**
+     * Get the number of games
+     *
+     * @return The number of games merged into the storage of the AI
+     */
+    unsigned long long GetNumberOfGames();
+
+    /**
+     * Get the games per second
+     *
+     * @return The number of games played per second in the last run
+     */
+    double GetGamesPerSecond();
+};
+
+#endif // SELF_PLAY_H
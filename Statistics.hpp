@@ -0,0 +1,212 @@
+/**
+ * Statistics - Header File
+ * libMorris
+ *
+ * Counters and timers of the game and the AI, collected only if the
+ * library is compiled with MORRIS_STATISTICS defined (-DMORRIS_STATISTICS).
+ * Without it the counters stay zero and the instrumentation compiles to
+ * nothing.
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#if defined(MORRIS_STATISTICS)
+/** Add a value to a statistics counter */
+#define STATISTICS_ADD(counter, value) ((counter) += (value))
+#else
+/** Add a value to a statistics counter (compiled out) */
+#define STATISTICS_ADD(counter, value) ((void)0)
+#endif
+
+/** Increment a statistics counter */
+#define STATISTICS_COUNT(counter) STATISTICS_ADD(counter, 1)
+
+/**
+ * Statistics counter updated by more threads
+ *
+ * The counter is a relaxed atomic, so it is read without waiting for
+ * the threads updating it (e.g. the background worker of the AI).
+ */
+class StatisticsCounter
+{
+private:
+    /** Value of the counter */
+    std::atomic<unsigned long long> value;
+
+public:
+    /**
+     * Construct statistics counter
+     *
+     * @param[in] value The initial value
+     */
+    StatisticsCounter(unsigned long long value = 0) : value(value)
+    {
+    }
+
+    StatisticsCounter(const StatisticsCounter& counter) : value(counter.Get())
+    {
+    }
+
+    StatisticsCounter& operator=(const StatisticsCounter& counter)
+    {
+        value.store(counter.Get(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    /**
+     * Add a value to the counter
+     *
+     * @param[in] value The value to add
+     *
+     * @return The counter
+     */
+    StatisticsCounter& operator+=(unsigned long long value)
+    {
+        this->value.fetch_add(value, std::memory_order_relaxed);
+        return *this;
+    }
+
+    /**
+     * Get the value of the counter
+     *
+     * @return The value
+     */
+    unsigned long long Get() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    operator unsigned long long() const
+    {
+        return Get();
+    }
+};
+
+/**
+ * Timer adding the time of its scope to a statistics counter
+ */
+class StatisticsTimer
+{
+#if defined(MORRIS_STATISTICS)
+private:
+    /** Pointer to the counter of the nanoseconds */
+    StatisticsCounter* nanoseconds;
+
+    /** Start of the measurement */
+    std::chrono::steady_clock::time_point start;
+
+public:
+    /**
+     * Construct statistics timer
+     *
+     * @param[out] nanoseconds Pointer to the counter to add the nanoseconds to at the end of the scope
+     */
+    explicit StatisticsTimer(StatisticsCounter* nanoseconds)
+        : nanoseconds(nanoseconds), start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~StatisticsTimer()
+    {
+        *nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()
+                        - start).count();
+    }
+#else
+public:
+    /**
+     * Construct statistics timer (compiled out)
+     */
+    explicit StatisticsTimer(StatisticsCounter*)
+    {
+    }
+#endif
+
+    StatisticsTimer(const StatisticsTimer&) = delete;
+    StatisticsTimer& operator=(const StatisticsTimer&) = delete;
+};
+
+/** Statistics of the games of a thread */
+struct GameStatistics
+{
+    /** Number of rejected placings */
+    unsigned long long numOfRejectedPlaces = 0;
+
+    /** Number of rejected moves */
+    unsigned long long numOfRejectedMoves = 0;
+
+    /** Number of rejected removals */
+    unsigned long long numOfRejectedRemoves = 0;
+};
+
+/** Statistics of a learning AI (the counters are updated by its background worker too) */
+struct LearningAIStatistics
+{
+    /** Number of steps looked up (not retries) */
+    StatisticsCounter numOfLookups = 0;
+
+    /** Number of lookups answered by the tablebase */
+    StatisticsCounter numOfTablebaseHits = 0;
+
+    /** Number of lookups answered by the storage */
+    StatisticsCounter numOfStorageHits = 0;
+
+    /** Number of lookups answered by the storage file */
+    StatisticsCounter numOfFileHits = 0;
+
+    /** Number of lookups answered by the best step table */
+    StatisticsCounter numOfTableHits = 0;
+
+    /** Number of lookups not answered (random steps) */
+    StatisticsCounter numOfMisses = 0;
+
+    /** Number of retries (random steps after rejected ones) */
+    StatisticsCounter numOfRetries = 0;
+
+    /** Number of stored games */
+    StatisticsCounter numOfStores = 0;
+
+    /** Number of stored steps */
+    StatisticsCounter numOfStoredSteps = 0;
+
+    /** Time of storing in nanoseconds */
+    StatisticsCounter storeNanoseconds = 0;
+
+    /** Number of merges */
+    StatisticsCounter numOfMerges = 0;
+
+    /** Number of merged steps */
+    StatisticsCounter numOfMergedSteps = 0;
+
+    /** Time of merging in nanoseconds */
+    StatisticsCounter mergeNanoseconds = 0;
+
+    /** Number of saves */
+    StatisticsCounter numOfSaves = 0;
+
+    /** Time of saving in nanoseconds */
+    StatisticsCounter saveNanoseconds = 0;
+
+    /** Number of steps in the storage (at the snapshot) */
+    std::size_t numOfStorageSteps = 0;
+
+    /** Memory of the storage in bytes (at the snapshot) */
+    std::size_t storageMemory = 0;
+
+    /** Number of records of the mapped storage file (at the snapshot) */
+    std::size_t numOfFileRecords = 0;
+
+    /** Number of steps in the history (at the snapshot) */
+    std::size_t historySize = 0;
+};
+
+#endif // STATISTICS_H
@@ -0,0 +1,815 @@
+/**
+ * Storage File Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "StorageFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "StorageFileWriter.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** Minimum number of records to sort by radix sort */
+const std::size_t MIN_NUM_OF_RADIX_SORTED_RECORDS = 65536;
+
+/** Number of bits of the digits of the radix sort */
+const unsigned int RADIX_SORT_DIGIT_BITS = 16;
+
+/** Number of ranks of the states of 8 places (3 ^ 8) */
+const unsigned int NUM_OF_WORD_RANKS = 6561;
+
+/** Number of ranks of the states of 24 places (3 ^ 24) */
+const unsigned long long NUM_OF_STATE_RANKS = 282429536481ull;
+
+/** Rank of the states of 8 places not ranked */
+const unsigned short NO_WORD_RANK = 0xFFFF;
+
+/** Number of changes codes of places and NO_PLACE (the ones of other changes follow) */
+const unsigned int NUM_OF_PLACE_CHANGES_CODES = 625;
+
+/** Number of counters codes (a win, a loss and any other counters) */
+const unsigned int NUM_OF_COUNTERS_CODES = 3;
+
+/** Maximum length of a variable length integer */
+const unsigned int MAX_VARIABLE_LENGTH = 10;
+
+/** Encoding of the blocks of base 3 states */
+const unsigned char RANKED_BLOCK_ENCODING = 0;
+
+/** Encoding of the blocks of other states */
+const unsigned char KEYED_BLOCK_ENCODING = 1;
+
+/** Rank tables of the packed states of 8 places (16 bits) */
+struct StorageFileRankTables
+{
+    /** Base 3 ranks of the packed states (NO_WORD_RANK if a place has the invalid value 3) */
+    unsigned short wordRanks[65536];
+
+    /** Packed states of the base 3 ranks */
+    unsigned short rankWords[NUM_OF_WORD_RANKS];
+};
+
+/**
+ * Generate the rank tables
+ *
+ * @return The rank tables
+ */
+StorageFileRankTables GenerateRankTables()
+{
+    StorageFileRankTables tables;
+    for (unsigned int word = 0; word < 65536; ++word)
+    {
+        unsigned int rank = 0;
+        for (int place = 7; place >= 0 && rank != NO_WORD_RANK; --place)
+        {
+            unsigned int value = (word >> (place * 2)) & 3;
+            rank = value == 3 ? NO_WORD_RANK : rank * 3 + value;
+        }
+
+        tables.wordRanks[word] = rank;
+        if (rank != NO_WORD_RANK)
+        {
+            tables.rankWords[rank] = word;
+        }
+    }
+
+    return tables;
+}
+
+/**
+ * Get the rank tables
+ *
+ * The tables are generated at the first use, so the storage files used
+ * during the static initialization of other translation units rank the
+ * states correctly.
+ *
+ * @return The rank tables
+ */
+const StorageFileRankTables& GetRankTables()
+{
+    static const StorageFileRankTables tables = GenerateRankTables();
+    return tables;
+}
+
+/**
+ * Write a variable length integer
+ *
+ * @param[in] value The integer
+ * @param[out] data Pointer to store the bytes in (appended)
+ */
+inline void WriteVariableLength(unsigned long long value, std::vector<unsigned char>* data)
+{
+    while (value >= 0x80)
+    {
+        data->push_back(static_cast<unsigned char>(value) | 0x80);
+        value >>= 7;
+    }
+    data->push_back(static_cast<unsigned char>(value));
+}
+
+/**
+ * Read a variable length integer
+ *
+ * @param[in,out] position Pointer to the position to read from (moved after the integer)
+ * @param[in] end The end of the data
+ * @param[out] value Pointer to store the integer in
+ *
+ * @return The integer is valid
+ */
+inline bool ReadVariableLength(const unsigned char** position, const unsigned char* end, unsigned long long* value)
+{
+    *value = 0;
+    for (unsigned int shift = 0; *position != end && shift < MAX_VARIABLE_LENGTH * 7; shift += 7)
+    {
+        unsigned char byte = *(*position)++;
+        *value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Read a record of a block of a compressed storage file
+ *
+ * @param[in,out] position Pointer to the position to read from (moved after the record)
+ * @param[in] end The end of the block
+ * @param[in] ranked The block has base 3 states
+ * @param[in,out] previous Pointer to the rank or the key of the previous record (replaced by the one of the record)
+ * @param[out] record Pointer to store the record in (without the state if the block has base 3 states)
+ *
+ * @return The record is valid
+ */
+inline bool ReadBlockRecord(const unsigned char** position, const unsigned char* end, bool ranked,
+                            unsigned long long* previous, StorageFileRecord* record)
+{
+    unsigned long long difference;
+    unsigned long long code;
+    if (!ReadVariableLength(position, end, &difference) || !ReadVariableLength(position, end, &code))
+    {
+        return false;
+    }
+
+    *previous += difference;
+    unsigned long long countersCode = code;
+    if (ranked)
+    {
+        unsigned long long changesCode = code / NUM_OF_COUNTERS_CODES;
+        countersCode = code % NUM_OF_COUNTERS_CODES;
+        if (*previous >= NUM_OF_STATE_RANKS || changesCode >= NUM_OF_PLACE_CHANGES_CODES + 0x10000)
+        {
+            return false;
+        }
+
+        record->key = changesCode - NUM_OF_PLACE_CHANGES_CODES;
+        if (changesCode < NUM_OF_PLACE_CHANGES_CODES)
+        {
+            unsigned char changes0 = changesCode / 25 - 1;
+            unsigned char changes1 = changesCode % 25 - 1;
+            record->key = static_cast<unsigned long long>(changes0) << 8 | changes1;
+        }
+    }
+    else
+    {
+        record->key = *previous;
+    }
+
+    if (countersCode == 0 || countersCode == 1)
+    {
+        record->wins = countersCode == 0 ? 1 : 0;
+        record->losses = countersCode == 1 ? 1 : 0;
+        return true;
+    }
+
+    unsigned long long wins;
+    unsigned long long losses;
+    if (countersCode != 2 || !ReadVariableLength(position, end, &wins) || !ReadVariableLength(position, end, &losses)
+            || wins > 0xFFFFFFFFull || losses > 0xFFFFFFFFull)
+    {
+        return false;
+    }
+    record->wins = static_cast<unsigned int>(wins);
+    record->losses = static_cast<unsigned int>(losses);
+
+    return true;
+}
+
+StorageFile::~StorageFile()
+{
+    Close();
+}
+
+bool StorageFile::IsStorageFile(std::string fileName)
+{
+    std::ifstream file;
+    file.open(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    char magic[sizeof(STORAGE_FILE_MAGIC)];
+    file.read(magic, sizeof(magic));
+
+    return file.good() && (std::memcmp(magic, STORAGE_FILE_MAGIC, sizeof(magic)) == 0
+                           || std::memcmp(magic, STORAGE_FILE_COMPRESSED_MAGIC, sizeof(magic)) == 0);
+}
+
+unsigned long long StorageFile::GetStateRank(unsigned long long stateKey)
+{
+    const StorageFileRankTables& tables = GetRankTables();
+    unsigned long long rank = 0;
+    for (int shift = 32; shift >= 0; shift -= 16)
+    {
+        unsigned short wordRank = tables.wordRanks[(stateKey >> shift) & 0xFFFF];
+        if (wordRank == NO_WORD_RANK)
+        {
+            return NO_STATE_RANK;
+        }
+        rank = rank * NUM_OF_WORD_RANKS + wordRank;
+    }
+
+    return rank;
+}
+
+unsigned long long StorageFile::GetRankState(unsigned long long rank)
+{
+    const StorageFileRankTables& tables = GetRankTables();
+    unsigned long long stateKey = 0;
+    for (int shift = 0; shift <= 32; shift += 16)
+    {
+        stateKey |= static_cast<unsigned long long>(tables.rankWords[rank % NUM_OF_WORD_RANKS]) << shift;
+        rank /= NUM_OF_WORD_RANKS;
+    }
+
+    return stateKey;
+}
+
+void StorageFile::EncodeBlock(const StorageFileRecord* records, std::size_t numOfRecords,
+                              std::vector<unsigned char>* block)
+{
+    bool ranked = true;
+    for (std::size_t index = 0; index < numOfRecords && ranked; ++index)
+    {
+        ranked = GetStateRank(records[index].key >> 16) != NO_STATE_RANK;
+    }
+    block->push_back(ranked ? RANKED_BLOCK_ENCODING : KEYED_BLOCK_ENCODING);
+
+    unsigned long long previous = 0;
+    for (std::size_t index = 0; index < numOfRecords; ++index)
+    {
+        const StorageFileRecord& record = records[index];
+        unsigned int countersCode = record.wins == 1 && record.losses == 0 ? 0
+                                    : record.wins == 0 && record.losses == 1 ? 1 : 2;
+        if (ranked)
+        {
+            // The changes are places or NO_PLACE mostly
+            unsigned char changes0 = record.key >> 8;
+            unsigned char changes1 = record.key;
+            unsigned char code0 = changes0 + 1;
+            unsigned char code1 = changes1 + 1;
+            unsigned long long changesCode = code0 < 25 && code1 < 25 ? code0 * 25 + code1
+                                             : NUM_OF_PLACE_CHANGES_CODES + (record.key & 0xFFFF);
+
+            unsigned long long rank = GetStateRank(record.key >> 16);
+            WriteVariableLength(rank - previous, block);
+            WriteVariableLength(changesCode * NUM_OF_COUNTERS_CODES + countersCode, block);
+            previous = rank;
+        }
+        else
+        {
+            WriteVariableLength(record.key - previous, block);
+            WriteVariableLength(countersCode, block);
+            previous = record.key;
+        }
+
+        if (countersCode == 2)
+        {
+            WriteVariableLength(record.wins, block);
+            WriteVariableLength(record.losses, block);
+        }
+    }
+}
+
+bool StorageFile::DecodeBlock(const unsigned char* block, std::size_t blockSize, std::size_t numOfRecords,
+                              std::vector<StorageFileRecord>* records)
+{
+    records->clear();
+    if (blockSize == 0 || (block[0] != RANKED_BLOCK_ENCODING && block[0] != KEYED_BLOCK_ENCODING))
+    {
+        return false;
+    }
+
+    bool ranked = block[0] == RANKED_BLOCK_ENCODING;
+    const unsigned char* position = block + 1;
+    const unsigned char* end = block + blockSize;
+    unsigned long long previous = 0;
+    records->reserve(numOfRecords);
+    for (std::size_t index = 0; index < numOfRecords; ++index)
+    {
+        StorageFileRecord record;
+        if (!ReadBlockRecord(&position, end, ranked, &previous, &record))
+        {
+            return false;
+        }
+
+        if (ranked)
+        {
+            record.key |= GetRankState(previous) << 16;
+        }
+        records->push_back(record);
+    }
+
+    // The last block is followed by the padding of the index
+    return true;
+}
+
+unsigned long long StorageFile::GetRecordKey(unsigned long long stateKey, unsigned char changes0,
+        unsigned char changes1)
+{
+    return stateKey << 16 | static_cast<unsigned long long>(changes0) << 8 | changes1;
+}
+
+unsigned long long StorageFile::CalculateChecksum(const StorageFileRecord* records, std::size_t numOfRecords,
+        unsigned long long checksum)
+{
+    // FNV-1a over the fields of the records
+    for (std::size_t index = 0; index < numOfRecords; ++index)
+    {
+        checksum = (checksum ^ records[index].key) * 0x100000001B3ull;
+        checksum = (checksum ^ records[index].wins) * 0x100000001B3ull;
+        checksum = (checksum ^ records[index].losses) * 0x100000001B3ull;
+    }
+
+    return checksum;
+}
+
+void StorageFile::Sort(std::vector<StorageFileRecord>* records)
+{
+    if (records->size() < MIN_NUM_OF_RADIX_SORTED_RECORDS)
+    {
+        std::sort(records->begin(), records->end(), [](const StorageFileRecord& a, const StorageFileRecord& b)
+        {
+            return a.key < b.key;
+        });
+        return;
+    }
+
+    // Sort the many records by the digits of their keys from the lowest one (skipping the digits all keys share)
+    std::vector<StorageFileRecord> sortedRecords(records->size());
+    std::vector<std::size_t> offsets(1 << RADIX_SORT_DIGIT_BITS);
+    const unsigned long long digitMask = (1ull << RADIX_SORT_DIGIT_BITS) - 1;
+    for (unsigned int shift = 0; shift < sizeof(unsigned long long) * 8; shift += RADIX_SORT_DIGIT_BITS)
+    {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (std::vector<StorageFileRecord>::const_iterator ri = records->cbegin(); ri != records->cend(); ++ri)
+        {
+            ++offsets[(ri->key >> shift) & digitMask];
+        }
+        if (offsets[(records->front().key >> shift) & digitMask] == records->size())
+        {
+            continue;
+        }
+
+        std::size_t offset = 0;
+        for (std::vector<std::size_t>::iterator oi = offsets.begin(); oi != offsets.end(); ++oi)
+        {
+            std::size_t count = *oi;
+            *oi = offset;
+            offset += count;
+        }
+        for (std::vector<StorageFileRecord>::const_iterator ri = records->cbegin(); ri != records->cend(); ++ri)
+        {
+            sortedRecords[offsets[(ri->key >> shift) & digitMask]++] = *ri;
+        }
+        records->swap(sortedRecords);
+    }
+}
+
+bool StorageFile::Write(std::string fileName, const std::vector<StorageFileRecord>& records, StorageFormat format)
+{
+    StorageFileWriter writer;
+    if (!writer.Create(fileName, format))
+    {
+        return false;
+    }
+
+    for (std::vector<StorageFileRecord>::const_iterator ri = records.cbegin(); ri != records.cend(); ++ri)
+    {
+        writer.Write(*ri);
+    }
+
+    return writer.Close();
+}
+
+bool StorageFile::Open(std::string fileName, bool verify)
+{
+    Close();
+
+#ifdef _WIN32
+    // The file can be renamed while open, so a file mapped by other AIs (e.g. by self play) can be replaced
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(StorageFileHeader)))
+    {
+        Close();
+        return false;
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    data = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr)
+    {
+        Close();
+        return false;
+    }
+#else
+    int file = open(fileName.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || fileStatus.st_size < static_cast<off_t>(sizeof(StorageFileHeader)))
+    {
+        close(file);
+        return false;
+    }
+    size = static_cast<std::size_t>(fileStatus.st_size);
+
+    // The mapping stays valid after closing the file
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+    {
+        size = 0;
+        return false;
+    }
+    data = static_cast<const unsigned char*>(mapping);
+#endif
+
+    if (std::memcmp(data, STORAGE_FILE_COMPRESSED_MAGIC, sizeof(STORAGE_FILE_COMPRESSED_MAGIC)) == 0)
+    {
+        return OpenCompressed(verify);
+    }
+
+    // Check the header
+    const StorageFileHeader* header = reinterpret_cast<const StorageFileHeader*>(data);
+    if (std::memcmp(header->magic, STORAGE_FILE_MAGIC, sizeof(header->magic)) != 0
+            || header->version != STORAGE_FILE_VERSION || header->recordSize != sizeof(StorageFileRecord)
+            || header->numOfRecords != (size - sizeof(StorageFileHeader)) / sizeof(StorageFileRecord))
+    {
+        Close();
+        return false;
+    }
+
+    records = reinterpret_cast<const StorageFileRecord*>(data + sizeof(StorageFileHeader));
+    numOfRecords = static_cast<std::size_t>(header->numOfRecords);
+
+    if (verify && CalculateChecksum(records, numOfRecords) != header->checksum)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void StorageFile::View(const StorageFileRecord* records, std::size_t numOfRecords)
+{
+    Close();
+
+    this->records = records;
+    this->numOfRecords = records != nullptr ? numOfRecords : 0;
+}
+
+void StorageFile::Close()
+{
+#ifdef _WIN32
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr)
+    {
+        CloseHandle(fileHandle);
+    }
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (data != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+#endif
+
+    data = nullptr;
+    size = 0;
+    records = nullptr;
+    numOfRecords = 0;
+    blocks = nullptr;
+    numOfBlocks = 0;
+    decodedRecords.clear();
+    foundRecords.clear();
+}
+
+bool StorageFile::IsOpen()
+{
+    return data != nullptr || records != nullptr;
+}
+
+std::size_t StorageFile::GetNumberOfRecords()
+{
+    return numOfRecords;
+}
+
+const StorageFileRecord* StorageFile::GetRecords()
+{
+    return records;
+}
+
+StorageFileRecord StorageFile::GetRecord(std::size_t index)
+{
+    if (records != nullptr)
+    {
+        return records[index];
+    }
+
+    if (!Decode(index / STORAGE_FILE_BLOCK_SIZE))
+    {
+        return { 0, 0, 0 };
+    }
+
+    return decodedRecords[index % STORAGE_FILE_BLOCK_SIZE];
+}
+
+std::size_t StorageFile::LowerBound(unsigned long long key, std::size_t first)
+{
+    if (first >= numOfRecords)
+    {
+        return numOfRecords;
+    }
+
+    if (records != nullptr)
+    {
+        return std::lower_bound(records + first, records + numOfRecords, key,
+                                [](const StorageFileRecord& record, unsigned long long key)
+        {
+            return record.key < key;
+        }) - records;
+    }
+
+    // The record is in the last block starting with a lesser key (or it is the first one searched from)
+    std::size_t firstBlock = first / STORAGE_FILE_BLOCK_SIZE;
+    std::size_t block = std::lower_bound(blocks + firstBlock + 1, blocks + numOfBlocks, key,
+                                         [](const StorageFileBlock& block, unsigned long long key)
+    {
+        return block.firstKey < key;
+    }) - blocks - 1;
+    if (!Decode(block))
+    {
+        return numOfRecords;
+    }
+
+    std::size_t blockFirst = block == firstBlock ? first % STORAGE_FILE_BLOCK_SIZE : 0;
+    std::size_t index = std::lower_bound(decodedRecords.cbegin() + blockFirst, decodedRecords.cend(), key,
+                                         [](const StorageFileRecord& record, unsigned long long key)
+    {
+        return record.key < key;
+    }) - decodedRecords.cbegin();
+
+    return block * STORAGE_FILE_BLOCK_SIZE + index;
+}
+
+unsigned long long StorageFile::GetChecksum()
+{
+    if (data == nullptr)
+    {
+        return 0;
+    }
+
+    if (blocks != nullptr)
+    {
+        return reinterpret_cast<const StorageFileCompressedHeader*>(data)->checksum;
+    }
+
+    return reinterpret_cast<const StorageFileHeader*>(data)->checksum;
+}
+
+const StorageFileRecord* StorageFile::Find(unsigned long long stateKey, std::size_t* count)
+{
+    *count = 0;
+    if (blocks != nullptr)
+    {
+        // Search the last block starting before the state and the ones starting with it
+        unsigned long long key = GetRecordKey(stateKey, 0, 0);
+        std::size_t block = std::lower_bound(blocks, blocks + numOfBlocks, key,
+                                             [](const StorageFileBlock& block, unsigned long long key)
+        {
+            return block.firstKey < key;
+        }) - blocks;
+
+        foundRecords.clear();
+        block = block > 0 ? block - 1 : 0;
+        while (block < numOfBlocks && FindInBlock(block, stateKey)
+                && ++block < numOfBlocks && (blocks[block].firstKey >> 16) == stateKey)
+        {
+        }
+
+        *count = foundRecords.size();
+        return foundRecords.data();
+    }
+
+    if (records == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Find the first record of the state (the records are sorted by key)
+    const StorageFileRecord* first = std::lower_bound(records, records + numOfRecords, GetRecordKey(stateKey, 0, 0),
+                                     [](const StorageFileRecord& record, unsigned long long key)
+    {
+        return record.key < key;
+    });
+
+    const StorageFileRecord* last = first;
+    while (last != records + numOfRecords && (last->key >> 16) == stateKey)
+    {
+        ++last;
+    }
+
+    *count = last - first;
+    return first;
+}
+
+bool StorageFile::OpenCompressed(bool verify)
+{
+    // Check the header and the place of the index
+    const StorageFileCompressedHeader* header = reinterpret_cast<const StorageFileCompressedHeader*>(data);
+    if (size < sizeof(StorageFileCompressedHeader) || header->version != STORAGE_FILE_VERSION
+            || header->blockSize != STORAGE_FILE_BLOCK_SIZE || header->indexOffset < sizeof(StorageFileCompressedHeader)
+            || header->indexOffset > size || header->indexOffset % sizeof(StorageFileBlock) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    // Only the last block can be shorter
+    std::size_t numOfIndexBlocks = (size - header->indexOffset) / sizeof(StorageFileBlock);
+    unsigned long long numOfBlockRecords = static_cast<unsigned long long>(numOfIndexBlocks) * header->blockSize;
+    if ((size - header->indexOffset) % sizeof(StorageFileBlock) != 0 || header->numOfRecords > numOfBlockRecords
+            || header->numOfRecords + header->blockSize <= numOfBlockRecords)
+    {
+        Close();
+        return false;
+    }
+
+    blocks = reinterpret_cast<const StorageFileBlock*>(data + header->indexOffset);
+    numOfBlocks = numOfIndexBlocks;
+    numOfRecords = static_cast<std::size_t>(header->numOfRecords);
+
+    if (verify)
+    {
+        unsigned long long checksum = STORAGE_FILE_CHECKSUM_BASIS;
+        for (std::size_t block = 0; block < numOfBlocks; ++block)
+        {
+            if (!Decode(block))
+            {
+                Close();
+                return false;
+            }
+            checksum = CalculateChecksum(decodedRecords.data(), decodedRecords.size(), checksum);
+        }
+
+        if (checksum != header->checksum)
+        {
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool StorageFile::Decode(std::size_t block)
+{
+    if (!decodedRecords.empty() && decodedBlock == block)
+    {
+        return true;
+    }
+
+    const unsigned char* blockData;
+    std::size_t blockDataSize;
+    decodedBlock = block;
+    if (!GetBlockData(block, &blockData, &blockDataSize)
+            || !DecodeBlock(blockData, blockDataSize, GetNumberOfBlockRecords(block), &decodedRecords))
+    {
+        decodedRecords.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool StorageFile::FindInBlock(std::size_t block, unsigned long long stateKey)
+{
+    const unsigned char* blockData;
+    std::size_t blockDataSize;
+    if (!GetBlockData(block, &blockData, &blockDataSize)
+            || (blockData[0] != RANKED_BLOCK_ENCODING && blockData[0] != KEYED_BLOCK_ENCODING))
+    {
+        return false;
+    }
+
+    // Compare the ranks of the states without unranking them (a state not ranked is not in the block)
+    bool ranked = blockData[0] == RANKED_BLOCK_ENCODING;
+    unsigned long long searched = ranked ? GetStateRank(stateKey) : stateKey;
+    if (searched == NO_STATE_RANK)
+    {
+        return true;
+    }
+
+    const unsigned char* position = blockData + 1;
+    const unsigned char* end = blockData + blockDataSize;
+    unsigned long long previous = 0;
+    for (std::size_t index = GetNumberOfBlockRecords(block); index > 0; --index)
+    {
+        StorageFileRecord record;
+        if (!ReadBlockRecord(&position, end, ranked, &previous, &record))
+        {
+            return false;
+        }
+
+        unsigned long long current = ranked ? previous : previous >> 16;
+        if (current > searched)
+        {
+            return false;
+        }
+        if (current == searched)
+        {
+            record.key = GetRecordKey(stateKey, record.key >> 8, record.key);
+            foundRecords.push_back(record);
+        }
+    }
+
+    return true;
+}
+
+bool StorageFile::GetBlockData(std::size_t block, const unsigned char** blockData, std::size_t* blockDataSize)
+{
+    // The block ends at the next one (the last one at the index)
+    const StorageFileCompressedHeader* header = reinterpret_cast<const StorageFileCompressedHeader*>(data);
+    unsigned long long begin = blocks[block].offset;
+    unsigned long long end = block + 1 < numOfBlocks ? blocks[block + 1].offset : header->indexOffset;
+    if (begin < sizeof(StorageFileCompressedHeader) || begin >= end || end > header->indexOffset)
+    {
+        return false;
+    }
+
+    *blockData = data + begin;
+    *blockDataSize = static_cast<std::size_t>(end - begin);
+    return true;
+}
+
+std::size_t StorageFile::GetNumberOfBlockRecords(std::size_t block)
+{
+    return std::min<std::size_t>(numOfRecords - block * STORAGE_FILE_BLOCK_SIZE, STORAGE_FILE_BLOCK_SIZE);
+}
@@ -0,0 +1,427 @@
+/**
+ * Storage File Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef STORAGE_FILE_H
+#define STORAGE_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** Format of the AI storage files */
+enum StorageFormat
+{
+    /** Raw game steps (12 bytes per game step, no header) */
+    Raw,
+
+    /** Header and sorted fixed width records, usable memory mapped */
+    Mapped,
+
+    /** Header, blocks of sorted records with delta encoded keys and variable length counters, and block index */
+    Compressed
+};
+
+/** Magic of the mapped storage files */
+const char STORAGE_FILE_MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'A', 'I' };
+
+/** Magic of the compressed storage files */
+const char STORAGE_FILE_COMPRESSED_MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'A', 'Z' };
+
+/**
+ * Version of the mapped and the compressed storage files
+ *
+ * 2: a mill formed again after a removal broke it counts as a new mill,
+ * the results of the files of version 1 were learned with the old rule.
+ */
+const unsigned int STORAGE_FILE_VERSION = 2;
+
+/** Number of records per block of the compressed storage files */
+const unsigned int STORAGE_FILE_BLOCK_SIZE = 128;
+
+/** Rank of the states not ranked (a place has the invalid value 3) */
+const unsigned long long NO_STATE_RANK = ~0ull;
+
+/** Checksum of no records */
+const unsigned long long STORAGE_FILE_CHECKSUM_BASIS = 0xCBF29CE484222325ull;
+
+/** Header of the mapped storage files */
+struct StorageFileHeader
+{
+    /** Magic of the file (STORAGE_FILE_MAGIC) */
+    char magic[8];
+
+    /** Version of the file format */
+    unsigned int version;
+
+    /** Size of a record in bytes */
+    unsigned int recordSize;
+
+    /** Number of records */
+    unsigned long long numOfRecords;
+
+    /** Checksum of the records */
+    unsigned long long checksum;
+};
+
+/** Header of the compressed storage files */
+struct StorageFileCompressedHeader
+{
+    /** Magic of the file (STORAGE_FILE_COMPRESSED_MAGIC) */
+    char magic[8];
+
+    /** Version of the file format */
+    unsigned int version;
+
+    /** Number of records per block except the last one (STORAGE_FILE_BLOCK_SIZE) */
+    unsigned int blockSize;
+
+    /** Number of records */
+    unsigned long long numOfRecords;
+
+    /** Checksum of the records (as the one of the mapped storage files) */
+    unsigned long long checksum;
+
+    /** Offset of the block index from the start of the file */
+    unsigned long long indexOffset;
+};
+
+/** Entry of the block index of the compressed storage files */
+struct StorageFileBlock
+{
+    /** Key of the first record of the block */
+    unsigned long long firstKey;
+
+    /** Offset of the block from the start of the file */
+    unsigned long long offset;
+};
+
+/** Record of the mapped storage files */
+struct StorageFileRecord
+{
+    /** Packed state of the game field and the changes (state << 16 | changes0 << 8 | changes1) */
+    unsigned long long key;
+
+    /** Wins with this state */
+    unsigned int wins;
+
+    /** Losses with this state */
+    unsigned int losses;
+};
+
+/**
+ * Mapped AI storage file
+ *
+ * The file is a StorageFileHeader followed by the StorageFileRecords
+ * sorted by key, in the byte order of the host. It is mapped to memory
+ * and read in place, so opening it does not depend on its size and the
+ * processes using the same file share its pages.
+ *
+ * A compressed file is a StorageFileCompressedHeader followed by blocks of
+ * the sorted records and the StorageFileBlock index of the blocks. A
+ * block starts with its encoding: 0 if the states are base 3 numbers
+ * (every place is empty or taken by one of the players), 1 otherwise. A
+ * record of the block is the difference of its key from the previous one
+ * (from 0 at the start of the block) and its code, as variable length
+ * integers (7 bits per byte, lowest first):
+ * - encoding 0: the difference of the base 3 rank of the state, and
+ *   ((changes code) * 3 + (counters code)), where the changes code is
+ *   (changes0 + 1) * 25 + (changes1 + 1) if both are places or NO_PLACE
+ *   (255 + 1 wraps to 0), 625 + (changes0 << 8 | changes1) otherwise
+ * - encoding 1: the difference of the key, and the counters code
+ * The counters code is 0 for a win, 1 for a loss and 2 for any other
+ * counters, followed by the wins and the losses. Lookups decode a single
+ * block found by the index, reading the file from the start decodes the
+ * blocks one after the other.
+ */
+class StorageFile
+{
+private:
+    /** Mapped content of the file */
+    const unsigned char* data = nullptr;
+
+    /** Size of the mapped content */
+    std::size_t size = 0;
+
+#ifdef _WIN32
+    /** Handle of the file */
+    void* fileHandle = nullptr;
+
+    /** Handle of the file mapping */
+    void* mappingHandle = nullptr;
+#endif
+
+    /** Records of the file */
+    const StorageFileRecord* records = nullptr;
+
+    /** Number of records of the file */
+    std::size_t numOfRecords = 0;
+
+    /** Block index of the compressed file (nullptr if the file is mapped) */
+    const StorageFileBlock* blocks = nullptr;
+
+    /** Number of blocks of the compressed file */
+    std::size_t numOfBlocks = 0;
+
+    /** Index of the decoded block */
+    std::size_t decodedBlock = 0;
+
+    /** Records of the decoded block (empty if none is decoded) */
+    std::vector<StorageFileRecord> decodedRecords;
+
+    /** Records found in the compressed file */
+    std::vector<StorageFileRecord> foundRecords;
+
+    /**
+     * Open a compressed file mapped already
+     *
+     * @param[in] verify Verify the checksum of the records (decodes the whole file)
+     *
+     * @return The header and the index of the file are valid
+     */
+    bool OpenCompressed(bool verify);
+
+    /**
+     * Get the encoded data of a block of the compressed file
+     *
+     * @param[in] block The index of the block
+     * @param[out] blockData Pointer to store the pointer to the data in
+     * @param[out] blockDataSize Pointer to store the size of the data in
+     *
+     * @return The block is inside the file
+     */
+    bool GetBlockData(std::size_t block, const unsigned char** blockData, std::size_t* blockDataSize);
+
+    /**
+     * Get the number of records of a block of the compressed file
+     *
+     * @param[in] block The index of the block
+     *
+     * @return The number of records
+     */
+    std::size_t GetNumberOfBlockRecords(std::size_t block);
+
+    /**
+     * Find the records of a state in a block of the compressed file
+     *
+     * Only the found records are decoded completely, the search stops
+     * at the first record after the state.
+     *
+     * @param[in] block The index of the block
+     * @param[in] stateKey The packed state of the game field
+     *
+     * @return The records of the state can continue in the next block (no record after the state)
+     */
+    bool FindInBlock(std::size_t block, unsigned long long stateKey);
+
+    /**
+     * Decode a block of the compressed file
+     *
+     * @param[in] block The index of the block
+     *
+     * @return Decoding was successful (the records are in decodedRecords)
+     */
+    bool Decode(std::size_t block);
+
+public:
+
+    /**
+     * Construct storage file
+     */
+    StorageFile() = default;
+
+    StorageFile(const StorageFile&) = delete;
+    StorageFile& operator=(const StorageFile&) = delete;
+
+    /**
+     * Destruct storage file
+     */
+    ~StorageFile();
+
+    /**
+     * Check if a file is a mapped storage file
+     *
+     * @param[in] fileName Filename of the file to check
+     *
+     * @return The file starts with the magic of the mapped or the compressed storage files
+     */
+    static bool IsStorageFile(std::string fileName);
+
+    /**
+     * Get the base 3 rank of a state
+     *
+     * @param[in] stateKey The packed state of the game field
+     *
+     * @return The rank in order of the states (NO_STATE_RANK if a place has the invalid value 3)
+     */
+    static unsigned long long GetStateRank(unsigned long long stateKey);
+
+    /**
+     * Get the state of a base 3 rank
+     *
+     * @param[in] rank The rank of the state
+     *
+     * @return The packed state of the game field
+     */
+    static unsigned long long GetRankState(unsigned long long rank);
+
+    /**
+     * Encode a block of records
+     *
+     * @param[in] records Pointer to the first record sorted by key
+     * @param[in] numOfRecords Number of records
+     * @param[out] block Pointer to store the encoded block in (appended)
+     */
+    static void EncodeBlock(const StorageFileRecord* records, std::size_t numOfRecords,
+                            std::vector<unsigned char>* block);
+
+    /**
+     * Decode a block of records
+     *
+     * @param[in] block Pointer to the encoded block
+     * @param[in] blockSize Size of the encoded block in bytes
+     * @param[in] numOfRecords Number of records of the block
+     * @param[out] records Pointer to store the records in (replaced)
+     *
+     * @return The block is valid
+     */
+    static bool DecodeBlock(const unsigned char* block, std::size_t blockSize, std::size_t numOfRecords,
+                            std::vector<StorageFileRecord>* records);
+
+    /**
+     * Get the key of a record
+     *
+     * @param[in] stateKey The packed state of the game field
+     * @param[in] changes0 The first change
+     * @param[in] changes1 The second change
+     *
+     * @return The key of the record
+     */
+    static unsigned long long GetRecordKey(unsigned long long stateKey, unsigned char changes0, unsigned char changes1);
+
+    /**
+     * Calculate the checksum of records
+     *
+     * @param[in] records Pointer to the first record
+     * @param[in] numOfRecords Number of records
+     * @param[in] checksum The checksum of the preceding records (to continue it)
+     *
+     * @return The checksum
+     */
+    static unsigned long long CalculateChecksum(const StorageFileRecord* records, std::size_t numOfRecords,
+            unsigned long long checksum = STORAGE_FILE_CHECKSUM_BASIS);
+
+    /**
+     * Sort records by key
+     *
+     * @param[in,out] records The records to sort
+     */
+    static void Sort(std::vector<StorageFileRecord>* records);
+
+    /**
+     * Write records to a mapped or a compressed storage file
+     *
+     * @param[in] fileName Filename of the file to write to
+     * @param[in] records The records sorted by key
+     * @param[in] format The format of the file (Mapped or Compressed)
+     *
+     * @return Writing was successful
+     */
+    static bool Write(std::string fileName, const std::vector<StorageFileRecord>& records,
+                      StorageFormat format = StorageFormat::Mapped);
+
+    /**
+     * Open and map the file
+     *
+     * @param[in] fileName Filename of the file to open
+     * @param[in] verify Verify the checksum of the records (reads the whole file)
+     *
+     * @return Opening was successful
+     */
+    bool Open(std::string fileName, bool verify = false);
+
+    /**
+     * View records in memory
+     *
+     * The records are used in place like the records of a mapped file
+     * without a header (the checksum is 0). They must stay valid until
+     * the view is closed.
+     *
+     * @param[in] records Pointer to the first record sorted by key
+     * @param[in] numOfRecords Number of records
+     */
+    void View(const StorageFileRecord* records, std::size_t numOfRecords);
+
+    /**
+     * Close the file
+     */
+    void Close();
+
+    /**
+     * Is the file open?
+     *
+     * @return The file is open (or records are viewed)
+     */
+    bool IsOpen();
+
+    /**
+     * Get the number of records
+     *
+     * @return The number of records
+     */
+    std::size_t GetNumberOfRecords();
+
+    /**
+     * Get the records
+     *
+     * @return Pointer to the first record (nullptr if the file is compressed)
+     */
+    const StorageFileRecord* GetRecords();
+
+    /**
+     * Get a record
+     *
+     * Decodes the block of the record if the file is compressed, so the
+     * records are read the fastest in order.
+     *
+     * @param[in] index The index of the record
+     *
+     * @return The record
+     */
+    StorageFileRecord GetRecord(std::size_t index);
+
+    /**
+     * Find the first record with a key not less than a key
+     *
+     * @param[in] key The key of the record
+     * @param[in] first The index of the record to search from
+     *
+     * @return The index of the record (the number of records if there is none)
+     */
+    std::size_t LowerBound(unsigned long long key, std::size_t first = 0);
+
+    /**
+     * Get the checksum of the records
+     *
+     * @return The checksum stored in the header (0 if not open)
+     */
+    unsigned long long GetChecksum();
+
+    /**
+     * Find the records of a state
+     *
+     * @param[in] stateKey The packed state of the game field
+     * @param[out] count The number of records of the state
+     *
+     * @return Pointer to the first record of the state (valid until the next call if the file is compressed)
+     */
+    const StorageFileRecord* Find(unsigned long long stateKey, std::size_t* count);
+};
+
+#endif // STORAGE_FILE_H
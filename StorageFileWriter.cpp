@@ -0,0 +1,152 @@
+/**
+ * Storage File Writer Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "StorageFileWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(STORAGE_FILE_WRITER_BUFFER_SIZE % STORAGE_FILE_BLOCK_SIZE == 0,
+              "The buffer of the writer has to hold whole blocks");
+
+bool StorageFileWriter::Create(std::string fileName, StorageFormat format)
+{
+    this->format = format;
+    numOfRecords = 0;
+    checksum = STORAGE_FILE_CHECKSUM_BASIS;
+    offset = 0;
+    buffer.clear();
+    buffer.reserve(STORAGE_FILE_WRITER_BUFFER_SIZE);
+    blocks.clear();
+
+    file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    // Reserve the place of the header
+    if (format == StorageFormat::Mapped)
+    {
+        StorageFileHeader header = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        offset = sizeof(header);
+    }
+    else if (format == StorageFormat::Compressed)
+    {
+        StorageFileCompressedHeader header = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        offset = sizeof(header);
+    }
+
+    return file.good();
+}
+
+void StorageFileWriter::Write(const StorageFileRecord& record)
+{
+    buffer.push_back(record);
+    if (buffer.size() == STORAGE_FILE_WRITER_BUFFER_SIZE)
+    {
+        Flush();
+    }
+}
+
+bool StorageFileWriter::Close()
+{
+    Flush();
+    if (format == StorageFormat::Mapped)
+    {
+        StorageFileHeader header;
+        std::memcpy(header.magic, STORAGE_FILE_MAGIC, sizeof(header.magic));
+        header.version = STORAGE_FILE_VERSION;
+        header.recordSize = sizeof(StorageFileRecord);
+        header.numOfRecords = numOfRecords;
+        header.checksum = checksum;
+
+        file.seekp(0, std::ios::beg);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    else if (format == StorageFormat::Compressed)
+    {
+        // The index is aligned to be read in place
+        const char padding[sizeof(StorageFileBlock)] = {};
+        std::size_t paddingSize = (sizeof(padding) - offset % sizeof(padding)) % sizeof(padding);
+        file.write(padding, paddingSize);
+
+        StorageFileCompressedHeader header;
+        std::memcpy(header.magic, STORAGE_FILE_COMPRESSED_MAGIC, sizeof(header.magic));
+        header.version = STORAGE_FILE_VERSION;
+        header.blockSize = STORAGE_FILE_BLOCK_SIZE;
+        header.numOfRecords = numOfRecords;
+        header.checksum = checksum;
+        header.indexOffset = offset + paddingSize;
+
+        file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(StorageFileBlock));
+        file.seekp(0, std::ios::beg);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    file.close();
+
+    return !file.fail();
+}
+
+unsigned long long StorageFileWriter::GetChecksum()
+{
+    return checksum;
+}
+
+void StorageFileWriter::Flush()
+{
+    if (format == StorageFormat::Mapped)
+    {
+        checksum = StorageFile::CalculateChecksum(buffer.data(), buffer.size(), checksum);
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(StorageFileRecord));
+        offset += buffer.size() * sizeof(StorageFileRecord);
+    }
+    else if (format == StorageFormat::Compressed)
+    {
+        // The buffer is flushed when it is full of blocks, only the last block can be shorter
+        checksum = StorageFile::CalculateChecksum(buffer.data(), buffer.size(), checksum);
+        for (std::size_t first = 0; first < buffer.size(); first += STORAGE_FILE_BLOCK_SIZE)
+        {
+            std::size_t count = std::min<std::size_t>(buffer.size() - first, STORAGE_FILE_BLOCK_SIZE);
+            blocks.push_back({ buffer[first].key, offset });
+            encodedBlock.clear();
+            StorageFile::EncodeBlock(buffer.data() + first, count, &encodedBlock);
+            file.write(reinterpret_cast<const char*>(encodedBlock.data()), encodedBlock.size());
+            offset += encodedBlock.size();
+        }
+    }
+    else
+    {
+        // The raw records are the fields of the game steps with counters 16 bits wide (saturated)
+        for (std::vector<StorageFileRecord>::const_iterator ri = buffer.cbegin(); ri != buffer.cend(); ++ri)
+        {
+            unsigned short state0 = ri->key >> 48;
+            unsigned short state1 = ri->key >> 32;
+            unsigned short state2 = ri->key >> 16;
+            unsigned char changes0 = ri->key >> 8;
+            unsigned char changes1 = ri->key;
+            unsigned short wins = std::min(ri->wins, 0xFFFFu);
+            unsigned short losses = std::min(ri->losses, 0xFFFFu);
+            StorageFileRecord record = { ri->key, wins, losses };
+            checksum = StorageFile::CalculateChecksum(&record, 1, checksum);
+            file.write(reinterpret_cast<const char*>(&state0), sizeof(state0));
+            file.write(reinterpret_cast<const char*>(&state1), sizeof(state1));
+            file.write(reinterpret_cast<const char*>(&state2), sizeof(state2));
+            file.write(reinterpret_cast<const char*>(&changes0), sizeof(changes0));
+            file.write(reinterpret_cast<const char*>(&changes1), sizeof(changes1));
+            file.write(reinterpret_cast<const char*>(&wins), sizeof(wins));
+            file.write(reinterpret_cast<const char*>(&losses), sizeof(losses));
+        }
+    }
+    numOfRecords += buffer.size();
+    buffer.clear();
+}
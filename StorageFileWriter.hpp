@@ -0,0 +1,107 @@
+/**
+ * Storage File Writer Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef STORAGE_FILE_WRITER_H
+#define STORAGE_FILE_WRITER_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "StorageFile.hpp"
+
+/** Number of records written at once (whole blocks of the compressed storage files) */
+const std::size_t STORAGE_FILE_WRITER_BUFFER_SIZE = 64 * STORAGE_FILE_BLOCK_SIZE;
+
+/**
+ * Sequential writer of a storage file
+ *
+ * The records are written in the order of their keys (except for the raw
+ * format) without keeping them in memory. The header of a mapped or a
+ * compressed storage file is written at closing, when the number and the
+ * checksum of the records are known, with the block index after the
+ * blocks of a compressed one.
+ */
+class StorageFileWriter
+{
+private:
+    /** The file */
+    std::ofstream file;
+
+    /** The format of the file */
+    StorageFormat format = StorageFormat::Mapped;
+
+    /** Records not written to the file yet */
+    std::vector<StorageFileRecord> buffer;
+
+    /** Number of the records written */
+    unsigned long long numOfRecords = 0;
+
+    /** Checksum of the records written */
+    unsigned long long checksum = STORAGE_FILE_CHECKSUM_BASIS;
+
+    /** Offset of the end of the file */
+    unsigned long long offset = 0;
+
+    /** Block index of the compressed storage file */
+    std::vector<StorageFileBlock> blocks;
+
+    /** Encoded block of the compressed storage file */
+    std::vector<unsigned char> encodedBlock;
+
+    /**
+     * Write the buffered records to the file
+     */
+    void Flush();
+
+public:
+
+    /**
+     * Construct storage file writer
+     */
+    StorageFileWriter() = default;
+
+    StorageFileWriter(const StorageFileWriter&) = delete;
+    StorageFileWriter& operator=(const StorageFileWriter&) = delete;
+
+    /**
+     * Create the file
+     *
+     * @param[in] fileName Filename of the file
+     * @param[in] format The format of the file
+     *
+     * @return Creating was successful
+     */
+    bool Create(std::string fileName, StorageFormat format);
+
+    /**
+     * Write a record
+     *
+     * @param[in] record The record
+     */
+    void Write(const StorageFileRecord& record);
+
+    /**
+     * Close the file
+     *
+     * @return Writing was successful
+     */
+    bool Close();
+
+    /**
+     * Get the checksum of the records written
+     *
+     * @return The checksum (of the saturated counters in the raw format)
+     */
+    unsigned long long GetChecksum();
+};
+
+#endif // STORAGE_FILE_WRITER_H
@@ -0,0 +1,153 @@
+/**
+ * Storage Journal Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "StorageJournal.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+std::string StorageJournal::GetFileName(std::string fileName)
+{
+    return fileName + STORAGE_JOURNAL_SUFFIX;
+}
+
+bool StorageJournal::Read(std::string fileName, unsigned long long baseChecksum,
+                          std::vector<StorageFileRecord>* records)
+{
+    std::ifstream file;
+    file.open(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    StorageJournalHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (file.fail() || std::memcmp(header.magic, STORAGE_JOURNAL_MAGIC, sizeof(header.magic)) != 0
+            || header.version != STORAGE_JOURNAL_VERSION || header.recordSize != sizeof(StorageFileRecord)
+            || header.baseChecksum != baseChecksum)
+    {
+        return false;
+    }
+
+    // The number of records of a batch is checked against the size of the file before allocating them
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(sizeof(header), std::ios::beg);
+
+    // Read the batches until the end or the first incomplete one
+    std::vector<StorageFileRecord> batchRecords;
+    while (true)
+    {
+        StorageJournalBatch batch;
+        file.read(reinterpret_cast<char*>(&batch), sizeof(batch));
+        if (file.fail())
+        {
+            break;
+        }
+
+        std::streamoff position = file.tellg();
+        if (position < 0 || static_cast<unsigned long long>(size - position) / sizeof(StorageFileRecord)
+                < batch.numOfRecords)
+        {
+            break;
+        }
+
+        batchRecords.resize(batch.numOfRecords);
+        file.read(reinterpret_cast<char*>(batchRecords.data()), batch.numOfRecords * sizeof(StorageFileRecord));
+        if (file.fail() || static_cast<unsigned int>(StorageFile::CalculateChecksum(batchRecords.data(),
+                batchRecords.size())) != batch.checksum)
+        {
+            break;
+        }
+
+        records->insert(records->end(), batchRecords.cbegin(), batchRecords.cend());
+    }
+
+    return true;
+}
+
+bool StorageJournal::Create(std::string fileName, unsigned long long baseChecksum)
+{
+    Close();
+
+    // Write to a temporary file first, the existing journal is valid until it is replaced
+    std::string temporaryFileName = fileName + ".tmp";
+    std::ofstream temporaryFile;
+    temporaryFile.open(temporaryFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!temporaryFile.is_open())
+    {
+        return false;
+    }
+
+    StorageJournalHeader header;
+    std::memcpy(header.magic, STORAGE_JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = STORAGE_JOURNAL_VERSION;
+    header.recordSize = sizeof(StorageFileRecord);
+    header.baseChecksum = baseChecksum;
+
+    temporaryFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    temporaryFile.close();
+    if (temporaryFile.fail())
+    {
+        std::remove(temporaryFileName.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    std::remove(fileName.c_str());
+#endif
+    if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+    {
+        return false;
+    }
+
+    file.open(fileName, std::ios::out | std::ios::binary | std::ios::app);
+    return file.is_open();
+}
+
+bool StorageJournal::Append(const std::vector<StorageFileRecord>& records)
+{
+    if (!file.is_open() || records.empty())
+    {
+        return file.is_open();
+    }
+
+    StorageJournalBatch batch;
+    batch.numOfRecords = records.size();
+    batch.checksum = static_cast<unsigned int>(StorageFile::CalculateChecksum(records.data(), records.size()));
+
+    file.write(reinterpret_cast<const char*>(&batch), sizeof(batch));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(StorageFileRecord));
+    file.flush();
+
+    // The batches after a failed one are not replayed (see Read), the journal ends with it
+    if (!file.good())
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void StorageJournal::Close()
+{
+    if (file.is_open())
+    {
+        file.close();
+    }
+    file.clear();
+}
+
+bool StorageJournal::IsOpen()
+{
+    return file.is_open();
+}
@@ -0,0 +1,129 @@
+/**
+ * Storage Journal Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef STORAGE_JOURNAL_H
+#define STORAGE_JOURNAL_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "StorageFile.hpp"
+
+/** Magic of the journal files */
+const char STORAGE_JOURNAL_MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'J', 'L' };
+
+/** Version of the journal file format */
+const unsigned int STORAGE_JOURNAL_VERSION = 1;
+
+/** Suffix of the journal file of a storage file */
+const char STORAGE_JOURNAL_SUFFIX[] = ".journal";
+
+/** Header of the journal files */
+struct StorageJournalHeader
+{
+    /** Magic of the file (STORAGE_JOURNAL_MAGIC) */
+    char magic[8];
+
+    /** Version of the file format */
+    unsigned int version;
+
+    /** Size of a record in bytes */
+    unsigned int recordSize;
+
+    /** Checksum of the storage file the journal continues */
+    unsigned long long baseChecksum;
+};
+
+/** Header of the batches of the journal files */
+struct StorageJournalBatch
+{
+    /** Number of records */
+    unsigned int numOfRecords;
+
+    /** Checksum of the records (the lower bits of StorageFile::CalculateChecksum) */
+    unsigned int checksum;
+};
+
+/**
+ * Append-only journal of a storage file
+ *
+ * The file is a StorageJournalHeader followed by batches of
+ * StorageFileRecords, the wins and losses to add to the storage file.
+ * A batch is written at once, a batch cut by a crash fails its checksum
+ * and ends the journal, so every batch is either replayed or not.
+ * The journal is replayed only on top of the storage file it continues.
+ */
+class StorageJournal
+{
+private:
+    /** The journal file opened for appending */
+    std::ofstream file;
+
+public:
+
+    /**
+     * Get the journal file name of a storage file
+     *
+     * @param[in] fileName Filename of the storage file
+     *
+     * @return Filename of the journal file
+     */
+    static std::string GetFileName(std::string fileName);
+
+    /**
+     * Read the records of a journal file
+     *
+     * @param[in] fileName Filename of the journal file
+     * @param[in] baseChecksum Checksum of the storage file loaded
+     * @param[out] records Pointer to append the records of the complete batches to
+     *
+     * @return The journal file exists and continues the storage file
+     */
+    static bool Read(std::string fileName, unsigned long long baseChecksum, std::vector<StorageFileRecord>* records);
+
+    /**
+     * Create an empty journal file and open it for appending
+     *
+     * The file replaces the existing one at once.
+     *
+     * @param[in] fileName Filename of the journal file
+     * @param[in] baseChecksum Checksum of the storage file the journal continues
+     *
+     * @return Creation was successful
+     */
+    bool Create(std::string fileName, unsigned long long baseChecksum);
+
+    /**
+     * Append a batch of records
+     *
+     * A failed append closes the journal file, a batch cut by the failure
+     * would end the journal for the later ones.
+     *
+     * @param[in] records The records to append
+     *
+     * @return Appending was successful
+     */
+    bool Append(const std::vector<StorageFileRecord>& records);
+
+    /**
+     * Close the journal file
+     */
+    void Close();
+
+    /**
+     * Is the journal file open?
+     *
+     * @return The journal file is open
+     */
+    bool IsOpen();
+};
+
+#endif // STORAGE_JOURNAL_H
@@ -0,0 +1,267 @@
+/**
+ * Storage Merge Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "StorageMerge.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "GameStepStorage.hpp"
+#include "Random.hpp"
+#include "StorageFileWriter.hpp"
+
+/**
+ * Sequential reader of a mapped or a compressed storage file
+ */
+class StorageMergeReader
+{
+private:
+    /** The file */
+    StorageFile file;
+
+    /** Index of the next record */
+    std::size_t index = 0;
+
+public:
+
+    /**
+     * Open the file
+     *
+     * @param[in] fileName Filename of the storage file
+     *
+     * @return The file is a mapped or a compressed storage file
+     */
+    bool Open(std::string fileName)
+    {
+        index = 0;
+        return file.Open(fileName);
+    }
+
+    /**
+     * Read the next record
+     *
+     * @param[out] record Pointer to store the record in
+     *
+     * @return A record is read (false at the end of the file)
+     */
+    bool Next(StorageFileRecord* record)
+    {
+        if (index == file.GetNumberOfRecords())
+        {
+            return false;
+        }
+
+        *record = file.GetRecord(index++);
+        return true;
+    }
+};
+
+StorageMerge::StorageMerge(std::string temporaryDirectory, std::size_t maxNumOfRecords)
+    : temporaryDirectory(temporaryDirectory), maxNumOfRecords(std::max<std::size_t>(maxNumOfRecords, 1)),
+      id(Random::GetSeed())
+{
+}
+
+StorageMerge::~StorageMerge()
+{
+    RemoveTemporaryRuns();
+}
+
+bool StorageMerge::Add(const StorageFileRecord& record)
+{
+    records.push_back(record);
+    if (records.size() >= maxNumOfRecords)
+    {
+        return WriteRun();
+    }
+
+    return true;
+}
+
+bool StorageMerge::AddFile(std::string fileName)
+{
+    StorageMergeReader reader;
+    if (!reader.Open(fileName))
+    {
+        return false;
+    }
+
+    runFileNames.push_back(fileName);
+    temporaryRuns.push_back(false);
+    return true;
+}
+
+bool StorageMerge::Write(std::string fileName, StorageFormat format)
+{
+    bool success = records.empty() || WriteRun();
+
+    // Merge the first runs into a new one until all of them can be merged at once
+    while (success && runFileNames.size() > STORAGE_MERGE_MAX_NUM_OF_RUNS)
+    {
+        std::vector<std::string> mergedFileNames(runFileNames.begin(),
+                runFileNames.begin() + STORAGE_MERGE_MAX_NUM_OF_RUNS);
+        std::string runFileName = CreateTemporaryFileName();
+        success = MergeRuns(mergedFileNames, runFileName, StorageFormat::Mapped);
+
+        for (std::size_t index = 0; index < STORAGE_MERGE_MAX_NUM_OF_RUNS; ++index)
+        {
+            if (temporaryRuns[index])
+            {
+                std::remove(runFileNames[index].c_str());
+            }
+        }
+        runFileNames.erase(runFileNames.begin(), runFileNames.begin() + STORAGE_MERGE_MAX_NUM_OF_RUNS);
+        temporaryRuns.erase(temporaryRuns.begin(), temporaryRuns.begin() + STORAGE_MERGE_MAX_NUM_OF_RUNS);
+        runFileNames.push_back(runFileName);
+        temporaryRuns.push_back(true);
+    }
+
+    // Write to a temporary file first, the file is replaced at once (and can be one of the merged ones)
+    std::string temporaryFileName = fileName + ".tmp";
+    success = success && MergeRuns(runFileNames, temporaryFileName, format);
+    RemoveTemporaryRuns();
+    if (!success)
+    {
+        std::remove(temporaryFileName.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    std::remove(fileName.c_str());
+#endif
+    return std::rename(temporaryFileName.c_str(), fileName.c_str()) == 0;
+}
+
+std::string StorageMerge::CreateTemporaryFileName()
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "StorageMerge.%016llx.%zu.tmp", id, numOfTemporaryRuns++);
+
+    if (temporaryDirectory.empty())
+    {
+        return name;
+    }
+    return temporaryDirectory + "/" + name;
+}
+
+bool StorageMerge::WriteRun()
+{
+    StorageFile::Sort(&records);
+
+    // Add up the results of the same game steps
+    std::size_t numOfRecords = 0;
+    for (std::size_t index = 0; index < records.size(); ++index)
+    {
+        if (numOfRecords > 0 && records[numOfRecords - 1].key == records[index].key)
+        {
+            StorageFileRecord& aggregated = records[numOfRecords - 1];
+            aggregated.wins = AddStepCount(aggregated.wins, records[index].wins);
+            aggregated.losses = AddStepCount(aggregated.losses, records[index].losses);
+            continue;
+        }
+
+        records[numOfRecords++] = records[index];
+    }
+    records.resize(numOfRecords);
+
+    std::string runFileName = CreateTemporaryFileName();
+    runFileNames.push_back(runFileName);
+    temporaryRuns.push_back(true);
+    bool success = StorageFile::Write(runFileName, records);
+
+    // Release the memory of the records
+    std::vector<StorageFileRecord>().swap(records);
+
+    return success;
+}
+
+bool StorageMerge::MergeRuns(const std::vector<std::string>& fileNames, std::string fileName, StorageFormat format)
+{
+    std::vector<StorageMergeReader> readers(fileNames.size());
+    for (std::size_t index = 0; index < fileNames.size(); ++index)
+    {
+        if (!readers[index].Open(fileNames[index]))
+        {
+            return false;
+        }
+    }
+
+    StorageFileWriter writer;
+    if (!writer.Create(fileName, format))
+    {
+        return false;
+    }
+
+    // Take the records in the order of the keys from the heap of the next record of every run
+    typedef std::pair<unsigned long long, std::size_t> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    std::vector<StorageFileRecord> nextRecords(readers.size());
+    for (std::size_t index = 0; index < readers.size(); ++index)
+    {
+        if (readers[index].Next(&nextRecords[index]))
+        {
+            heap.push({ nextRecords[index].key, index });
+        }
+    }
+
+    StorageFileRecord merged = { 0, 0, 0 };
+    bool hasMerged = false;
+    while (!heap.empty())
+    {
+        std::size_t index = heap.top().second;
+        heap.pop();
+
+        // Add up the results of the same game steps
+        const StorageFileRecord& record = nextRecords[index];
+        if (hasMerged && merged.key == record.key)
+        {
+            merged.wins = AddStepCount(merged.wins, record.wins);
+            merged.losses = AddStepCount(merged.losses, record.losses);
+        }
+        else
+        {
+            if (hasMerged)
+            {
+                writer.Write(merged);
+            }
+            merged = record;
+            hasMerged = true;
+        }
+
+        if (readers[index].Next(&nextRecords[index]))
+        {
+            heap.push({ nextRecords[index].key, index });
+        }
+    }
+    if (hasMerged)
+    {
+        writer.Write(merged);
+    }
+
+    return writer.Close();
+}
+
+void StorageMerge::RemoveTemporaryRuns()
+{
+    for (std::size_t index = 0; index < runFileNames.size(); ++index)
+    {
+        if (temporaryRuns[index])
+        {
+            std::remove(runFileNames[index].c_str());
+        }
+    }
+
+    runFileNames.clear();
+    temporaryRuns.clear();
+    records.clear();
+}
@@ -0,0 +1,145 @@
+/**
+ * Storage Merge Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef STORAGE_MERGE_H
+#define STORAGE_MERGE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "StorageFile.hpp"
+
+/** Default maximum number of records kept in memory by a merge (256 MB, twice as much while sorting) */
+const std::size_t STORAGE_MERGE_MAX_NUM_OF_RECORDS = 16 * 1024 * 1024;
+
+/** Maximum number of runs merged at once (more runs are merged in several passes) */
+const std::size_t STORAGE_MERGE_MAX_NUM_OF_RUNS = 64;
+
+/**
+ * External merge of AI storage files
+ *
+ * The added records are collected in memory up to a limit, then sorted,
+ * aggregated and written to a temporary run (a mapped storage file).
+ * The runs and the added storage files (sorted already) are
+ * merged by key at last, adding up the wins and losses of the same keys,
+ * so the memory used does not depend on the size of the storage files.
+ */
+class StorageMerge
+{
+private:
+    /** Directory of the temporary runs */
+    std::string temporaryDirectory;
+
+    /** Maximum number of records kept in memory */
+    std::size_t maxNumOfRecords;
+
+    /** Records not written to a run yet */
+    std::vector<StorageFileRecord> records;
+
+    /** Filenames of the runs to merge */
+    std::vector<std::string> runFileNames;
+
+    /** Runs are temporary (removed after merging) */
+    std::vector<bool> temporaryRuns;
+
+    /** Identifier of the merge in the names of the temporary runs (random) */
+    unsigned long long id;
+
+    /** Number of temporary runs created */
+    std::size_t numOfTemporaryRuns = 0;
+
+    /**
+     * Get the filename of a new temporary run
+     *
+     * @return The filename in the temporary directory
+     */
+    std::string CreateTemporaryFileName();
+
+    /**
+     * Sort, aggregate and write the records in memory to a temporary run
+     *
+     * @return Writing was successful
+     */
+    bool WriteRun();
+
+    /**
+     * Merge runs into a file
+     *
+     * @param[in] fileNames Filenames of the runs
+     * @param[in] fileName Filename of the file to write to
+     * @param[in] format The format of the file
+     *
+     * @return Merging was successful
+     */
+    static bool MergeRuns(const std::vector<std::string>& fileNames, std::string fileName, StorageFormat format);
+
+    /**
+     * Remove the temporary runs
+     */
+    void RemoveTemporaryRuns();
+
+public:
+
+    /**
+     * Construct storage merge
+     *
+     * @param[in] temporaryDirectory The directory to write the temporary runs to (the current one if empty)
+     * @param[in] maxNumOfRecords The maximum number of records kept in memory
+     */
+    explicit StorageMerge(std::string temporaryDirectory = "",
+                          std::size_t maxNumOfRecords = STORAGE_MERGE_MAX_NUM_OF_RECORDS);
+
+    StorageMerge(const StorageMerge&) = delete;
+    StorageMerge& operator=(const StorageMerge&) = delete;
+
+    /**
+     * Destruct storage merge
+     *
+     * Removes the temporary runs not merged.
+     */
+    ~StorageMerge();
+
+    /**
+     * Add a record
+     *
+     * @param[in] record The record to add the wins and losses of
+     *
+     * @return Adding was successful (writing the run if the memory is full)
+     */
+    bool Add(const StorageFileRecord& record);
+
+    /**
+     * Add a mapped or a compressed storage file
+     *
+     * The file is merged as it is (its records are sorted), it is not
+     * read until writing.
+     *
+     * @param[in] fileName Filename of the storage file
+     *
+     * @return The file is a valid storage file
+     */
+    bool AddFile(std::string fileName);
+
+    /**
+     * Write the merged records
+     *
+     * Merge the added records and files into a storage file, then start
+     * a new merge.
+     *
+     * @param[in] fileName Filename of the file to write to (replaced at once)
+     * @param[in] format The format of the file
+     *
+     * @return Writing was successful
+     */
+    bool Write(std::string fileName, StorageFormat format = StorageFormat::Mapped);
+};
+
+#endif // STORAGE_MERGE_H
@@ -0,0 +1,83 @@
+/**
+ * Symmetry - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "GameConstants.hpp"
+
+/**
+ * Number of symmetries of the field
+ *
+ * the symmetries are indexed like this:
+ * bit 0-1 - rotation by 90 degrees (0-3 times)
+ * bit 2 - reflection to the diagonal of place 0 and 4 (before the rotation)
+ * bit 3 - swap of the inner and outer squares
+ */
+const unsigned char NUM_OF_SYMMETRIES = 16;
+
+/** Identity symmetry */
+const unsigned char IDENTITY_SYMMETRY = 0;
+
+/**
+ * Transform a place with a symmetry
+ *
+ * @param[in] symmetry The symmetry
+ * @param[in] place The place (NO_PLACE is left unchanged)
+ *
+ * @return The transformed place
+ */
+inline unsigned char TransformPlace(unsigned char symmetry, unsigned char place)
+{
+    if (place >= NUM_OF_FIELD_PLACES)
+    {
+        return place;
+    }
+
+    unsigned char square = place / NUM_OF_SQUARE_PLACES;
+    unsigned char squarePlace = place % NUM_OF_SQUARE_PLACES;
+
+    // Reflect to the diagonal
+    if (symmetry & 4)
+    {
+        squarePlace = (NUM_OF_SQUARE_PLACES - squarePlace) % NUM_OF_SQUARE_PLACES;
+    }
+
+    // Rotate by 90 degrees
+    squarePlace = (squarePlace + (symmetry & 3) * NUM_OF_PLACES_TO_SHIFT) % NUM_OF_SQUARE_PLACES;
+
+    // Swap the inner and outer squares
+    if (symmetry & 8)
+    {
+        square = NUM_OF_SQUARES - 1 - square;
+    }
+
+    return square * NUM_OF_SQUARE_PLACES + squarePlace;
+}
+
+/**
+ * Get the inverse of a symmetry
+ *
+ * @param[in] symmetry The symmetry
+ *
+ * @return The symmetry transforming the places back
+ */
+inline unsigned char GetInverseSymmetry(unsigned char symmetry)
+{
+    // Reflections and swaps are their own inverses, rotations are not
+    if (symmetry & 4)
+    {
+        return symmetry;
+    }
+
+    return (symmetry & ~3) | ((4 - (symmetry & 3)) & 3);
+}
+
+#endif // SYMMETRY_H
@@ -0,0 +1,647 @@
+/**
+ * Tablebase Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "Tablebase.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <type_traits>
+
+// The positions are ranked on the places of Nine Men's Morris
+static_assert(std::is_same<Game, BasicGame<NineMensMorris>>::value,
+              "The tablebase is implemented for Nine Men's Morris");
+
+/** Number of positions solved by a thread at once */
+const unsigned long long TABLEBASE_CHUNK_SIZE = 1 << 16;
+
+/** Maximum number of pieces of a player supported */
+const unsigned char TABLEBASE_MAX_NUM_OF_PIECES = 9;
+
+/**
+ * Create the table of the binomial coefficients
+ *
+ * @return The binomial coefficients (n choose k)
+ */
+std::array<std::array<unsigned long long, NUM_OF_FIELD_PLACES + 1>, NUM_OF_FIELD_PLACES + 1> CreateBinomials()
+{
+    std::array<std::array<unsigned long long, NUM_OF_FIELD_PLACES + 1>, NUM_OF_FIELD_PLACES + 1> binomials = {};
+    for (unsigned char n = 0; n <= NUM_OF_FIELD_PLACES; ++n)
+    {
+        binomials[n][0] = 1;
+        for (unsigned char k = 1; k <= n; ++k)
+        {
+            binomials[n][k] = binomials[n - 1][k - 1] + (k < n ? binomials[n - 1][k] : 0);
+        }
+    }
+
+    return binomials;
+}
+
+/** Binomial coefficients to rank the combinations of the places */
+const std::array<std::array<unsigned long long, NUM_OF_FIELD_PLACES + 1>, NUM_OF_FIELD_PLACES + 1> BINOMIALS =
+    CreateBinomials();
+
+/**
+ * Get the rank of a combination of places
+ *
+ * The skipped places are left out of the numbering of the places.
+ *
+ * @param[in] board The bitboard of the places
+ * @param[in] skippedPlaces The bitboard of the skipped places
+ *
+ * @return The colexicographic rank of the places
+ */
+unsigned long long GetRank(Bitboard board, Bitboard skippedPlaces)
+{
+    unsigned long long rank = 0;
+    for (unsigned char count = 1; board != 0; ++count)
+    {
+        unsigned char place = PopPlace(&board);
+        place -= CountPlaces(skippedPlaces & (GetPlaceMask(place) - 1));
+        rank += BINOMIALS[place][count];
+    }
+
+    return rank;
+}
+
+/**
+ * Get the combination of places of a rank
+ *
+ * @param[in] rank The colexicographic rank of the places
+ * @param[in] numOfPlaces The number of places in the combination
+ * @param[in] skippedPlaces The bitboard of the skipped places
+ *
+ * @return The bitboard of the places
+ */
+Bitboard GetCombination(unsigned long long rank, unsigned char numOfPlaces, Bitboard skippedPlaces)
+{
+    // Select the places in the numbering without the skipped ones
+    Bitboard numbered = 0;
+    unsigned char place = NUM_OF_FIELD_PLACES;
+    for (unsigned char count = numOfPlaces; count > 0; --count)
+    {
+        do
+        {
+            --place;
+        }
+        while (BINOMIALS[place][count] > rank);
+        rank -= BINOMIALS[place][count];
+        numbered |= GetPlaceMask(place);
+    }
+
+    // Number the places without the skipped ones
+    Bitboard board = 0;
+    Bitboard freePlaces = FULL_BOARD & ~skippedPlaces;
+    for (unsigned char index = 0; numbered != 0; ++index)
+    {
+        unsigned char freePlace = PopPlace(&freePlaces);
+        if (numbered & GetPlaceMask(index))
+        {
+            board |= GetPlaceMask(freePlace);
+            numbered &= ~GetPlaceMask(index);
+        }
+    }
+
+    return board;
+}
+
+/**
+ * Count the mills of a place
+ *
+ * @param[in] pieces The pieces of a player
+ * @param[in] place The place of a piece of the player
+ *
+ * @return The number of mills including the place
+ */
+inline unsigned char CountPlaceMills(Bitboard pieces, unsigned char place)
+{
+    unsigned char numOfMills = 0;
+    for (MillSet placeMills = GetPlaceMills<NineMensMorris>(place); placeMills != 0;)
+    {
+        Bitboard millMask = NineMensMorris::GetMillMask(PopPlace(&placeMills));
+        numOfMills += (pieces & millMask) == millMask;
+    }
+
+    return numOfMills;
+}
+
+/**
+ * Mark a position as candidate
+ *
+ * @param[in] index The index of the value of the position
+ * @param[in,out] candidates The bits of the positions
+ */
+inline void MarkCandidate(unsigned long long index, std::atomic<unsigned long long>* candidates)
+{
+    candidates[index / 64].fetch_or(1ull << (index % 64), std::memory_order_relaxed);
+}
+
+std::size_t Tablebase::GetClassIndex(unsigned char numOfPieces, unsigned char numOfOtherPieces) const
+{
+    return (numOfPieces - TABLEBASE_MIN_NUM_OF_PIECES) * (maxNumOfPieces - TABLEBASE_MIN_NUM_OF_PIECES + 1)
+           + numOfOtherPieces - TABLEBASE_MIN_NUM_OF_PIECES;
+}
+
+unsigned long long Tablebase::GetClassSize(unsigned char numOfPieces, unsigned char numOfOtherPieces)
+{
+    return BINOMIALS[NUM_OF_FIELD_PLACES][numOfPieces]
+           * BINOMIALS[NUM_OF_FIELD_PLACES - numOfPieces][numOfOtherPieces];
+}
+
+unsigned long long Tablebase::GetIndex(Bitboard pieces, Bitboard otherPieces) const
+{
+    unsigned char numOfPieces = CountPlaces(pieces);
+    unsigned char numOfOtherPieces = CountPlaces(otherPieces);
+
+    return classOffsets[GetClassIndex(numOfPieces, numOfOtherPieces)]
+           + GetRank(pieces, 0) * BINOMIALS[NUM_OF_FIELD_PLACES - numOfPieces][numOfOtherPieces]
+           + GetRank(otherPieces, pieces);
+}
+
+void Tablebase::GetPosition(unsigned long long index, Bitboard* pieces, Bitboard* otherPieces) const
+{
+    std::size_t classIndex = 0;
+    while (classOffsets[classIndex + 1] <= index)
+    {
+        ++classIndex;
+    }
+
+    unsigned char numOfClasses = maxNumOfPieces - TABLEBASE_MIN_NUM_OF_PIECES + 1;
+    unsigned char numOfPieces = classIndex / numOfClasses + TABLEBASE_MIN_NUM_OF_PIECES;
+    unsigned char numOfOtherPieces = classIndex % numOfClasses + TABLEBASE_MIN_NUM_OF_PIECES;
+    unsigned long long numOfOtherCombinations = BINOMIALS[NUM_OF_FIELD_PLACES - numOfPieces][numOfOtherPieces];
+
+    index -= classOffsets[classIndex];
+    *pieces = GetCombination(index / numOfOtherCombinations, numOfPieces, 0);
+    *otherPieces = GetCombination(index % numOfOtherCombinations, numOfOtherPieces, *pieces);
+}
+
+bool Tablebase::HasMove(Bitboard pieces, Bitboard otherPieces)
+{
+    // Same as Game::CheckHasMove
+    if (CountPlaces(pieces) <= 3)
+    {
+        return true;
+    }
+
+    Bitboard emptyPlaces = FULL_BOARD & ~(pieces | otherPieces);
+    while (pieces != 0)
+    {
+        if (NineMensMorris::GetAdjacentMask(PopPlace(&pieces)) & emptyPlaces)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Tablebase::AddTurnOption(Bitboard pieces, Bitboard otherPieces, Outcome* outcome) const
+{
+    outcome->hasOption = true;
+
+    // The other player can not move
+    if (!HasMove(otherPieces, pieces))
+    {
+        outcome->minWinDistance = 1;
+        return;
+    }
+
+    unsigned char value = values[GetIndex(otherPieces, pieces)];
+    if (IsLoss(value))
+    {
+        outcome->minWinDistance = std::min<unsigned int>(outcome->minWinDistance, GetDistance(value) + 1);
+    }
+    else if (IsWin(value))
+    {
+        outcome->maxLossDistance = std::max<unsigned int>(outcome->maxLossDistance, GetDistance(value) + 1);
+    }
+    else
+    {
+        outcome->hasOpenOption = true;
+    }
+}
+
+void Tablebase::AddRemoveOptions(Bitboard pieces, Bitboard otherPieces, unsigned char numOfRemovals,
+                                 Outcome* outcome) const
+{
+    // Same as Game::CheckRemove, pieces in mills only if every piece is in a mill
+    Bitboard millPlaces = GetMillPlaces<NineMensMorris>(FindMills<NineMensMorris>(otherPieces));
+    Bitboard removablePieces = millPlaces == otherPieces ? otherPieces : otherPieces & ~millPlaces;
+    while (removablePieces != 0)
+    {
+        Bitboard remainingPieces = otherPieces & ~GetPlaceMask(PopPlace(&removablePieces));
+        if (CountPlaces(remainingPieces) < TABLEBASE_MIN_NUM_OF_PIECES)
+        {
+            outcome->hasOption = true;
+            outcome->minWinDistance = 1;
+        }
+        else if (numOfRemovals > 1)
+        {
+            AddRemoveOptions(pieces, remainingPieces, numOfRemovals - 1, outcome);
+        }
+        else
+        {
+            AddTurnOption(pieces, remainingPieces, outcome);
+        }
+    }
+}
+
+void Tablebase::AddMoveOptions(Bitboard pieces, Bitboard otherPieces, Outcome* outcome) const
+{
+    // Same as Game::CheckMove, jumping anywhere with 3 pieces
+    // The new mills are the ones including the place moved to
+    Bitboard emptyPlaces = FULL_BOARD & ~(pieces | otherPieces);
+    bool flying = CountPlaces(pieces) <= 3;
+
+    Bitboard fromPlaces = pieces;
+    while (fromPlaces != 0)
+    {
+        unsigned char fromPlace = PopPlace(&fromPlaces);
+        Bitboard toPlaces = flying ? emptyPlaces : NineMensMorris::GetAdjacentMask(fromPlace) & emptyPlaces;
+        while (toPlaces != 0)
+        {
+            unsigned char toPlace = PopPlace(&toPlaces);
+            Bitboard movedPieces = (pieces & ~GetPlaceMask(fromPlace)) | GetPlaceMask(toPlace);
+            unsigned char numOfNewMills = CountPlaceMills(movedPieces, toPlace);
+            if (numOfNewMills > 0)
+            {
+                AddRemoveOptions(movedPieces, otherPieces, numOfNewMills, outcome);
+            }
+            else
+            {
+                AddTurnOption(movedPieces, otherPieces, outcome);
+            }
+        }
+    }
+}
+
+unsigned char Tablebase::GetOutcomeValue(const Outcome& outcome)
+{
+    // The player to move can not move
+    if (!outcome.hasOption)
+    {
+        return 1;
+    }
+
+    if (outcome.minWinDistance <= TABLEBASE_MAX_DISTANCE)
+    {
+        return outcome.minWinDistance + 1;
+    }
+
+    if (!outcome.hasOpenOption && outcome.maxLossDistance <= TABLEBASE_MAX_DISTANCE)
+    {
+        return outcome.maxLossDistance + 1;
+    }
+
+    return TABLEBASE_DRAW;
+}
+
+void Tablebase::MarkPredecessors(Bitboard pieces, Bitboard otherPieces,
+                                 std::atomic<unsigned long long>* candidates) const
+{
+    Bitboard emptyPlaces = FULL_BOARD & ~(pieces | otherPieces);
+    bool flying = CountPlaces(otherPieces) <= 3;
+    unsigned char numOfPieces = CountPlaces(pieces);
+
+    // Move the pieces of the other player back, the new mills were the ones including the place moved to
+    Bitboard toPlaces = otherPieces;
+    while (toPlaces != 0)
+    {
+        unsigned char toPlace = PopPlace(&toPlaces);
+        unsigned char numOfNewMills = CountPlaceMills(otherPieces, toPlace);
+        Bitboard fromPlaces = flying ? emptyPlaces : NineMensMorris::GetAdjacentMask(toPlace) & emptyPlaces;
+        while (fromPlaces != 0)
+        {
+            Bitboard fromMask = GetPlaceMask(PopPlace(&fromPlaces));
+            Bitboard previousPieces = (otherPieces & ~GetPlaceMask(toPlace)) | fromMask;
+            if (numOfNewMills == 0)
+            {
+                MarkCandidate(GetIndex(previousPieces, pieces), candidates);
+            }
+
+            // Put the removed pieces back on any of the empty places
+            Bitboard removedPlaces = emptyPlaces & ~fromMask;
+            if (numOfNewMills == 1 && numOfPieces < maxNumOfPieces)
+            {
+                for (Bitboard places = removedPlaces; places != 0;)
+                {
+                    MarkCandidate(GetIndex(previousPieces, pieces | GetPlaceMask(PopPlace(&places))), candidates);
+                }
+            }
+            else if (numOfNewMills == 2 && numOfPieces + 1 < maxNumOfPieces)
+            {
+                for (Bitboard places = removedPlaces; places != 0;)
+                {
+                    Bitboard firstMask = GetPlaceMask(PopPlace(&places));
+                    for (Bitboard secondPlaces = places; secondPlaces != 0;)
+                    {
+                        MarkCandidate(GetIndex(previousPieces, pieces | firstMask | GetPlaceMask(PopPlace(&secondPlaces))),
+                                      candidates);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Tablebase::Solve(unsigned long long firstIndex, unsigned long long lastIndex,
+                      const std::atomic<unsigned long long>* candidates, std::atomic<unsigned long long>* nextCandidates,
+                      std::vector<std::pair<unsigned long long, unsigned char>>* solved) const
+{
+    for (unsigned long long wordIndex = firstIndex; wordIndex < lastIndex; wordIndex += 64)
+    {
+        unsigned long long word = candidates[wordIndex / 64].load(std::memory_order_relaxed);
+        for (unsigned long long index = wordIndex; word != 0; ++index, word >>= 1)
+        {
+            if (!(word & 1) || index >= lastIndex || values[index] != TABLEBASE_DRAW)
+            {
+                continue;
+            }
+
+            Bitboard pieces;
+            Bitboard otherPieces;
+            GetPosition(index, &pieces, &otherPieces);
+
+            Outcome outcome;
+            AddMoveOptions(pieces, otherPieces, &outcome);
+            unsigned char value = GetOutcomeValue(outcome);
+            if (value != TABLEBASE_DRAW)
+            {
+                solved->push_back({ index, value });
+                MarkPredecessors(pieces, otherPieces, nextCandidates);
+            }
+        }
+    }
+}
+
+void Tablebase::Resize(unsigned char maxNumOfPieces)
+{
+    this->maxNumOfPieces = maxNumOfPieces;
+
+    classOffsets.clear();
+    unsigned long long offset = 0;
+    for (unsigned char numOfPieces = TABLEBASE_MIN_NUM_OF_PIECES; numOfPieces <= maxNumOfPieces; ++numOfPieces)
+    {
+        for (unsigned char numOfOtherPieces = TABLEBASE_MIN_NUM_OF_PIECES; numOfOtherPieces <= maxNumOfPieces;
+                ++numOfOtherPieces)
+        {
+            classOffsets.push_back(offset);
+            offset += GetClassSize(numOfPieces, numOfOtherPieces);
+        }
+    }
+    classOffsets.push_back(offset);
+
+    values.assign(offset, TABLEBASE_DRAW);
+}
+
+unsigned long long Tablebase::CalculateChecksum() const
+{
+    unsigned long long checksum = 0xCBF29CE484222325ull;
+    for (std::vector<unsigned char>::const_iterator vi = values.cbegin(); vi != values.cend(); ++vi)
+    {
+        checksum = (checksum ^ *vi) * 0x100000001B3ull;
+    }
+
+    return checksum;
+}
+
+bool Tablebase::Generate(unsigned char maxNumOfPieces, unsigned int numOfThreads)
+{
+    if (maxNumOfPieces < TABLEBASE_MIN_NUM_OF_PIECES || maxNumOfPieces > TABLEBASE_MAX_NUM_OF_PIECES)
+    {
+        return false;
+    }
+
+    if (numOfThreads == 0)
+    {
+        numOfThreads = std::thread::hardware_concurrency();
+    }
+    numOfThreads = numOfThreads > 0 ? numOfThreads : 1;
+
+    Resize(maxNumOfPieces);
+
+    // Every position is a candidate in the first pass
+    std::size_t numOfWords = (values.size() + 63) / 64;
+    std::vector<std::atomic<unsigned long long>> candidates(numOfWords);
+    std::vector<std::atomic<unsigned long long>> nextCandidates(numOfWords);
+    for (std::size_t word = 0; word < numOfWords; ++word)
+    {
+        candidates[word].store(~0ull, std::memory_order_relaxed);
+        nextCandidates[word].store(0, std::memory_order_relaxed);
+    }
+
+    // Every pass solves the positions of the next distance from the values of the previous passes
+    std::vector<std::vector<std::pair<unsigned long long, unsigned char>>> solved(numOfThreads);
+    for (unsigned int distance = 0; distance <= TABLEBASE_MAX_DISTANCE; ++distance)
+    {
+        std::atomic<unsigned long long> nextIndex(0);
+        std::vector<std::thread> threads;
+        for (unsigned int thread = 0; thread < numOfThreads; ++thread)
+        {
+            threads.push_back(std::thread([this, &nextIndex, &candidates, &nextCandidates, &solved, thread]()
+            {
+                unsigned long long firstIndex;
+                while ((firstIndex = nextIndex.fetch_add(TABLEBASE_CHUNK_SIZE)) < values.size())
+                {
+                    Solve(firstIndex, std::min<unsigned long long>(firstIndex + TABLEBASE_CHUNK_SIZE, values.size()),
+                          candidates.data(), nextCandidates.data(), &solved[thread]);
+                }
+            }));
+        }
+
+        // Apply the solved values only when every thread is done reading the values of the previous passes
+        for (unsigned int thread = 0; thread < numOfThreads; ++thread)
+        {
+            threads[thread].join();
+        }
+
+        bool hasSolved = false;
+        for (unsigned int thread = 0; thread < numOfThreads; ++thread)
+        {
+            for (std::vector<std::pair<unsigned long long, unsigned char>>::const_iterator si = solved[thread].cbegin();
+                    si != solved[thread].cend(); ++si)
+            {
+                values[si->first] = si->second;
+            }
+            hasSolved = hasSolved || !solved[thread].empty();
+            solved[thread].clear();
+        }
+
+        if (!hasSolved)
+        {
+            break;
+        }
+
+        candidates.swap(nextCandidates);
+        for (std::size_t word = 0; word < numOfWords; ++word)
+        {
+            nextCandidates[word].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    return true;
+}
+
+bool Tablebase::Load(std::string fileName)
+{
+    std::ifstream file;
+    file.open(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    TablebaseFileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (file.fail() || std::memcmp(header.magic, TABLEBASE_FILE_MAGIC, sizeof(header.magic)) != 0
+            || header.version != TABLEBASE_FILE_VERSION || header.maxNumOfPieces < TABLEBASE_MIN_NUM_OF_PIECES
+            || header.maxNumOfPieces > TABLEBASE_MAX_NUM_OF_PIECES)
+    {
+        return false;
+    }
+
+    Resize(header.maxNumOfPieces);
+    file.read(reinterpret_cast<char*>(values.data()), values.size());
+    if (file.fail() || header.numOfValues != values.size() || header.checksum != CalculateChecksum())
+    {
+        maxNumOfPieces = 0;
+        values.clear();
+        classOffsets.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool Tablebase::Save(std::string fileName) const
+{
+    std::ofstream file;
+    file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    TablebaseFileHeader header;
+    std::memcpy(header.magic, TABLEBASE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TABLEBASE_FILE_VERSION;
+    header.maxNumOfPieces = maxNumOfPieces;
+    header.numOfValues = values.size();
+    header.checksum = CalculateChecksum();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(values.data()), values.size());
+    file.close();
+
+    return !file.fail();
+}
+
+bool Tablebase::Probe(Bitboard pieces, Bitboard otherPieces, unsigned char numOfRemovals, unsigned char* value) const
+{
+    unsigned char numOfPieces = CountPlaces(pieces);
+    unsigned char numOfOtherPieces = CountPlaces(otherPieces);
+    if (numOfPieces < TABLEBASE_MIN_NUM_OF_PIECES || numOfPieces > maxNumOfPieces
+            || numOfOtherPieces < TABLEBASE_MIN_NUM_OF_PIECES || numOfOtherPieces > maxNumOfPieces
+            || (pieces & otherPieces) != 0)
+    {
+        return false;
+    }
+
+    if (numOfRemovals == 0)
+    {
+        *value = values[GetIndex(pieces, otherPieces)];
+        return true;
+    }
+
+    // Evaluate the removals, they are part of the turn
+    Outcome outcome;
+    AddRemoveOptions(pieces, otherPieces, numOfRemovals, &outcome);
+    *value = GetOutcomeValue(outcome);
+
+    return true;
+}
+
+bool Tablebase::Probe(Game* game, unsigned char* value) const
+{
+    GameState state = game->GetGameState();
+    if ((state != GameState::Move && state != GameState::Remove) || game->GetDeck(1) > 0 || game->GetDeck(2) > 0)
+    {
+        return false;
+    }
+
+    unsigned char player = game->GetCurrentPlayer();
+    return Probe(game->GetPieces(player), game->GetPieces(NUM_OF_PLAYERS + 1 - player),
+                 state == GameState::Remove ? game->GetNumberOfMills() : 0, value);
+}
+
+bool Tablebase::GetBestAction(Game* game, GameAction* action, Random* random) const
+{
+    if (random == nullptr)
+    {
+        random = &Random::GetThreadRandom();
+    }
+
+    unsigned char value;
+    if (!Probe(game, &value))
+    {
+        return false;
+    }
+
+    GameActionList actions;
+    game->GetActions(&actions);
+    if (actions.size == 0)
+    {
+        return false;
+    }
+
+    // Rank the wins by the fewest, the losses by the most turns, draws in between
+    unsigned char player = game->GetCurrentPlayer();
+    int bestRank = 0;
+    unsigned char numOfBestActions = 0;
+    for (unsigned char index = 0; index < actions.size; ++index)
+    {
+        Game position = *game;
+        position.Apply(actions.actions[index]);
+
+        // Ending the game is a win in 1 turn, the value of the other player is inverted with a turn more
+        unsigned char actionValue = 2;
+        if (position.GetGameState() != GameState::End)
+        {
+            if (!Probe(&position, &actionValue))
+            {
+                actionValue = TABLEBASE_DRAW;
+            }
+            else if (position.GetCurrentPlayer() != player && actionValue != TABLEBASE_DRAW)
+            {
+                actionValue = GetDistance(actionValue) + 2;
+            }
+        }
+
+        int rank = IsWin(actionValue) ? 512 - actionValue : (IsLoss(actionValue) ? actionValue - 512 : 0);
+
+        // Select randomly between the actions of the same rank
+        if (numOfBestActions == 0 || rank > bestRank)
+        {
+            bestRank = rank;
+            numOfBestActions = 0;
+        }
+        if (rank == bestRank && random->Next(++numOfBestActions) == 0)
+        {
+            *action = actions.actions[index];
+        }
+    }
+
+    return true;
+}
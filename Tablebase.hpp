@@ -0,0 +1,368 @@
+/**
+ * Tablebase Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Bitboard.hpp"
+#include "Game.hpp"
+#include "GameAction.hpp"
+#include "Random.hpp"
+
+/** Magic of the tablebase files */
+const char TABLEBASE_FILE_MAGIC[8] = { 'M', 'O', 'R', 'R', 'I', 'S', 'T', 'B' };
+
+/** Version of the tablebase file format */
+const unsigned int TABLEBASE_FILE_VERSION = 1;
+
+/** Minimum number of pieces of a player in the tablebase positions */
+const unsigned char TABLEBASE_MIN_NUM_OF_PIECES = 3;
+
+/** Value of the positions neither player can force to win */
+const unsigned char TABLEBASE_DRAW = 0;
+
+/** Maximum distance of the positions solved (the longer ones are draws) */
+const unsigned char TABLEBASE_MAX_DISTANCE = 254;
+
+/** Header of the tablebase files */
+struct TablebaseFileHeader
+{
+    /** Magic of the file (TABLEBASE_FILE_MAGIC) */
+    char magic[8];
+
+    /** Version of the file format */
+    unsigned int version;
+
+    /** Maximum number of pieces of a player */
+    unsigned int maxNumOfPieces;
+
+    /** Number of values */
+    unsigned long long numOfValues;
+
+    /** Checksum of the values */
+    unsigned long long checksum;
+};
+
+/**
+ * Endgame tablebase
+ *
+ * Holds the value of every position of the moving (and flying) phase
+ * with at least 3 and at most the maximum number of pieces per player,
+ * from the view of the player to move. The value is TABLEBASE_DRAW or
+ * the distance to the end of the game plus one, counted in turns
+ * (a move with its removals), the player to move wins the odd distances
+ * and loses the even ones.
+ *
+ * The positions are indexed by the numbers of pieces and the rank of
+ * the pieces of the player to move and the other player among the
+ * combinations of the places. Positions with pending removals are
+ * evaluated from their successors when probed.
+ *
+ * The index holds no mill bookkeeping. It depends on the rule that the
+ * mills broken by a removal are forgotten (see Game::Remove), so the
+ * stored mills of the players are always the mills of their pieces.
+ */
+class Tablebase
+{
+private:
+    /** Maximum number of pieces of a player */
+    unsigned char maxNumOfPieces = 0;
+
+    /** Values of the positions */
+    std::vector<unsigned char> values;
+
+    /** First value index of the classes (the numbers of pieces of the players) */
+    std::vector<unsigned long long> classOffsets;
+
+    /** Outcome of the options of a position */
+    struct Outcome
+    {
+        /** Minimum distance of the options winning */
+        unsigned int minWinDistance = TABLEBASE_MAX_DISTANCE + 1;
+
+        /** Maximum distance of the options losing */
+        unsigned int maxLossDistance = 0;
+
+        /** Some options are draws or not solved */
+        bool hasOpenOption = false;
+
+        /** Some options exist */
+        bool hasOption = false;
+    };
+
+    /**
+     * Get the index of a class
+     *
+     * @param[in] numOfPieces The number of pieces of the player to move
+     * @param[in] numOfOtherPieces The number of pieces of the other player
+     *
+     * @return The index of the class
+     */
+    std::size_t GetClassIndex(unsigned char numOfPieces, unsigned char numOfOtherPieces) const;
+
+    /**
+     * Get the number of positions of a class
+     *
+     * @param[in] numOfPieces The number of pieces of the player to move
+     * @param[in] numOfOtherPieces The number of pieces of the other player
+     *
+     * @return The number of positions
+     */
+    static unsigned long long GetClassSize(unsigned char numOfPieces, unsigned char numOfOtherPieces);
+
+    /**
+     * Get the index of a position
+     *
+     * @param[in] pieces The pieces of the player to move
+     * @param[in] otherPieces The pieces of the other player
+     *
+     * @return The index of the value of the position
+     */
+    unsigned long long GetIndex(Bitboard pieces, Bitboard otherPieces) const;
+
+    /**
+     * Get the position of an index
+     *
+     * @param[in] index The index of the value of the position
+     * @param[out] pieces Pointer to store the pieces of the player to move in
+     * @param[out] otherPieces Pointer to store the pieces of the other player in
+     */
+    void GetPosition(unsigned long long index, Bitboard* pieces, Bitboard* otherPieces) const;
+
+    /**
+     * Check if the player to move has move
+     *
+     * @param[in] pieces The pieces of the player to move
+     * @param[in] otherPieces The pieces of the other player
+     *
+     * @return The player to move has move
+     */
+    static bool HasMove(Bitboard pieces, Bitboard otherPieces);
+
+    /**
+     * Add the option of giving the turn to the other player
+     *
+     * @param[in] pieces The pieces of the player to move after the move
+     * @param[in] otherPieces The pieces of the other player
+     * @param[in,out] outcome The outcome to add the option to
+     */
+    void AddTurnOption(Bitboard pieces, Bitboard otherPieces, Outcome* outcome) const;
+
+    /**
+     * Add the options of removing pieces of the other player
+     *
+     * @param[in] pieces The pieces of the player to move
+     * @param[in] otherPieces The pieces of the other player
+     * @param[in] numOfRemovals The number of pieces to remove
+     * @param[in,out] outcome The outcome to add the options to
+     */
+    void AddRemoveOptions(Bitboard pieces, Bitboard otherPieces, unsigned char numOfRemovals,
+                          Outcome* outcome) const;
+
+    /**
+     * Add the options of moving pieces
+     *
+     * @param[in] pieces The pieces of the player to move
+     * @param[in] otherPieces The pieces of the other player
+     * @param[in,out] outcome The outcome to add the options to
+     */
+    void AddMoveOptions(Bitboard pieces, Bitboard otherPieces, Outcome* outcome) const;
+
+    /**
+     * Get the value of an outcome
+     *
+     * @param[in] outcome The outcome of the options of a position
+     *
+     * @return The value of the position
+     */
+    static unsigned char GetOutcomeValue(const Outcome& outcome);
+
+    /**
+     * Mark the predecessors of a position
+     *
+     * Mark every position the position may be the successor of,
+     * a move of the other player with its removals.
+     *
+     * @param[in] pieces The pieces of the player to move
+     * @param[in] otherPieces The pieces of the other player
+     * @param[in,out] candidates The bits of the positions to mark
+     */
+    void MarkPredecessors(Bitboard pieces, Bitboard otherPieces, std::atomic<unsigned long long>* candidates) const;
+
+    /**
+     * Solve the positions of a range for the next distance
+     *
+     * @param[in] firstIndex The first index of the range (multiple of 64)
+     * @param[in] lastIndex The index after the range
+     * @param[in] candidates The bits of the positions to solve
+     * @param[in,out] nextCandidates The bits to mark the predecessors of the solved positions in
+     * @param[out] solved Pointer to append the indexes and values of the solved positions to
+     */
+    void Solve(unsigned long long firstIndex, unsigned long long lastIndex,
+               const std::atomic<unsigned long long>* candidates, std::atomic<unsigned long long>* nextCandidates,
+               std::vector<std::pair<unsigned long long, unsigned char>>* solved) const;
+
+    /**
+     * Set the size of the tablebase
+     *
+     * @param[in] maxNumOfPieces The maximum number of pieces of a player
+     */
+    void Resize(unsigned char maxNumOfPieces);
+
+    /**
+     * Calculate the checksum of the values
+     *
+     * @return The FNV-1a hash of the values
+     */
+    unsigned long long CalculateChecksum() const;
+
+public:
+
+    /**
+     * Generate the tablebase
+     *
+     * Solve the positions by retrograde analysis, the positions of the
+     * next distance are solved from the ones already solved, until no
+     * more can be solved. Only the predecessors of the positions solved
+     * in the previous pass are evaluated again.
+     *
+     * @param[in] maxNumOfPieces The maximum number of pieces of a player (3 to 9)
+     * @param[in] numOfThreads The number of threads to solve with (0 is the number of cores)
+     *
+     * @return Generation was successful
+     */
+    bool Generate(unsigned char maxNumOfPieces, unsigned int numOfThreads = 0);
+
+    /**
+     * Load the tablebase from file
+     *
+     * @param[in] fileName Filename of the tablebase file to load from
+     *
+     * @return Loading was successful
+     */
+    bool Load(std::string fileName);
+
+    /**
+     * Save the tablebase to file
+     *
+     * @param[in] fileName Filename of the tablebase file to save to
+     *
+     * @return Saving was successful
+     */
+    bool Save(std::string fileName) const;
+
+    /**
+     * Get the maximum number of pieces
+     *
+     * @return The maximum number of pieces of a player (0 if not generated or loaded)
+     */
+    unsigned char GetMaxNumberOfPieces() const;
+
+    /**
+     * Get the number of positions
+     *
+     * @return The number of positions with value
+     */
+    unsigned long long GetNumberOfPositions() const;
+
+    /**
+     * Probe the value of a position
+     *
+     * @param[in] pieces The pieces of the player to move
+     * @param[in] otherPieces The pieces of the other player
+     * @param[in] numOfRemovals The number of pieces to remove by the player to move
+     * @param[out] value Pointer to store the value of the position in
+     *
+     * @return The position is in the tablebase
+     */
+    bool Probe(Bitboard pieces, Bitboard otherPieces, unsigned char numOfRemovals, unsigned char* value) const;
+
+    /**
+     * Probe the value of the position of a game
+     *
+     * @param[in] game Pointer to the game in moving or removing state with empty decks
+     * @param[out] value Pointer to store the value of the position in
+     *
+     * @return The position is in the tablebase
+     */
+    bool Probe(Game* game, unsigned char* value) const;
+
+    /**
+     * Get the best action in the position of a game
+     *
+     * Win in the fewest turns, keep the draw or lose in the most turns.
+     *
+     * @param[in] game Pointer to the game in moving or removing state with empty decks
+     * @param[out] action Pointer to store the best action in
+     * @param[in,out] random Pointer to the generator of the ties (nullptr is the one of the current thread)
+     *
+     * @return The position is in the tablebase
+     */
+    bool GetBestAction(Game* game, GameAction* action, Random* random = nullptr) const;
+
+    /**
+     * Check if a value is a win
+     *
+     * @param[in] value The value of a position
+     *
+     * @return The player to move wins
+     */
+    static bool IsWin(unsigned char value);
+
+    /**
+     * Check if a value is a loss
+     *
+     * @param[in] value The value of a position
+     *
+     * @return The player to move loses
+     */
+    static bool IsLoss(unsigned char value);
+
+    /**
+     * Get the distance of a value
+     *
+     * @param[in] value The value of a position (not a draw)
+     *
+     * @return The number of turns to the end of the game
+     */
+    static unsigned char GetDistance(unsigned char value);
+};
+
+inline unsigned char Tablebase::GetMaxNumberOfPieces() const
+{
+    return maxNumOfPieces;
+}
+
+inline unsigned long long Tablebase::GetNumberOfPositions() const
+{
+    return values.size();
+}
+
+inline bool Tablebase::IsWin(unsigned char value)
+{
+    return value != TABLEBASE_DRAW && (value - 1) % 2 == 1;
+}
+
+inline bool Tablebase::IsLoss(unsigned char value)
+{
+    return value != TABLEBASE_DRAW && (value - 1) % 2 == 0;
+}
+
+inline unsigned char Tablebase::GetDistance(unsigned char value)
+{
+    return value - 1;
+}
+
+#endif // TABLEBASE_H
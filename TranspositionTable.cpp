@@ -0,0 +1,143 @@
+/**
+ * Transposition Table Class
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "TranspositionTable.hpp"
+
+#include <new>
+
+/** Bit of the data of the used slots (the data of the empty slots is 0) */
+const unsigned long long TRANSPOSITION_USED_BIT = 1ull << 56;
+
+bool TranspositionTable::Resize(std::size_t megabytes)
+{
+    // Use a power of 2 number of buckets to index by the hash bits
+    std::size_t size = 1;
+    while (size * 2 * sizeof(TranspositionBucket) <= (megabytes << 20))
+    {
+        size *= 2;
+    }
+
+    try
+    {
+        memory.assign(size * sizeof(TranspositionBucket) + CACHE_LINE_SIZE, 0);
+    }
+    catch (const std::bad_alloc&)
+    {
+        memory.clear();
+        buckets = nullptr;
+        numOfBuckets = 0;
+        return false;
+    }
+
+    // Construct the buckets at the first cache line boundary of the memory (value-initialized, the default
+    // initialization of the atomics would leave them indeterminate even on the zeroed memory)
+    std::size_t offset = (CACHE_LINE_SIZE - reinterpret_cast<std::size_t>(memory.data()) % CACHE_LINE_SIZE)
+                         % CACHE_LINE_SIZE;
+    buckets = reinterpret_cast<TranspositionBucket*>(memory.data() + offset);
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        new (&buckets[index]) TranspositionBucket();
+    }
+    numOfBuckets = size;
+    generation = 0;
+
+    return true;
+}
+
+void TranspositionTable::Clear()
+{
+    for (std::size_t index = 0; index < numOfBuckets; ++index)
+    {
+        for (unsigned int slot = 0; slot < TRANSPOSITION_BUCKET_SIZE; ++slot)
+        {
+            buckets[index].slots[slot].key.store(0, std::memory_order_relaxed);
+            buckets[index].slots[slot].data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::NewSearch()
+{
+    ++generation;
+}
+
+bool TranspositionTable::Probe(unsigned long long hash, TranspositionEntry* entry) const
+{
+    if (numOfBuckets == 0)
+    {
+        return false;
+    }
+
+    const TranspositionBucket& bucket = buckets[hash & (numOfBuckets - 1)];
+    for (unsigned int slot = 0; slot < TRANSPOSITION_BUCKET_SIZE; ++slot)
+    {
+        unsigned long long data = bucket.slots[slot].data.load(std::memory_order_relaxed);
+        if (data != 0 && (bucket.slots[slot].key.load(std::memory_order_relaxed) ^ data) == hash)
+        {
+            Unpack(data, entry);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TranspositionTable::Store(unsigned long long hash, const TranspositionEntry& entry)
+{
+    if (numOfBuckets == 0)
+    {
+        return;
+    }
+
+    // Replace the entry of the position, or the one of an earlier search or the shallowest search
+    TranspositionBucket& bucket = buckets[hash & (numOfBuckets - 1)];
+    TranspositionSlot* replaced = &bucket.slots[0];
+    unsigned int replacedPriority = ~0u;
+    for (unsigned int slot = 0; slot < TRANSPOSITION_BUCKET_SIZE; ++slot)
+    {
+        unsigned long long data = bucket.slots[slot].data.load(std::memory_order_relaxed);
+        if ((bucket.slots[slot].key.load(std::memory_order_relaxed) ^ data) == hash)
+        {
+            replaced = &bucket.slots[slot];
+            break;
+        }
+
+        unsigned int priority = (data >> 16 & 0xFF) + (static_cast<unsigned char>(data >> 48) == generation ? 256 : 0);
+        if (priority < replacedPriority)
+        {
+            replaced = &bucket.slots[slot];
+            replacedPriority = priority;
+        }
+    }
+
+    unsigned long long data = Pack(entry, generation);
+    replaced->key.store(hash ^ data, std::memory_order_relaxed);
+    replaced->data.store(data, std::memory_order_relaxed);
+}
+
+unsigned long long TranspositionTable::Pack(const TranspositionEntry& entry, unsigned char generation)
+{
+    return static_cast<unsigned long long>(static_cast<unsigned short>(entry.value))
+           | static_cast<unsigned long long>(entry.depth) << 16
+           | static_cast<unsigned long long>(entry.bound) << 24
+           | static_cast<unsigned long long>(entry.action.from) << 32
+           | static_cast<unsigned long long>(entry.action.to) << 40
+           | static_cast<unsigned long long>(generation) << 48 | TRANSPOSITION_USED_BIT;
+}
+
+void TranspositionTable::Unpack(unsigned long long data, TranspositionEntry* entry)
+{
+    entry->value = static_cast<short>(data & 0xFFFF);
+    entry->depth = data >> 16;
+    entry->bound = data >> 24;
+    entry->action.from = data >> 32;
+    entry->action.to = data >> 40;
+}
@@ -0,0 +1,178 @@
+/**
+ * Transposition Table Class - Header File
+ * libMorris
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <vector>
+
+#include "GameAction.hpp"
+
+/** Number of entries in a bucket (a bucket fills a cache line) */
+const unsigned int TRANSPOSITION_BUCKET_SIZE = 4;
+
+/** Size of a cache line in bytes */
+const std::size_t CACHE_LINE_SIZE = 64;
+
+/** Bound of a transposition table value */
+enum TranspositionBound
+{
+    /** Exact value */
+    Exact,
+
+    /** Value is a lower bound (search failed high) */
+    Lower,
+
+    /** Value is an upper bound (search failed low) */
+    Upper
+};
+
+/** Entry of the transposition table */
+struct TranspositionEntry
+{
+    /** Value of the position */
+    short value = 0;
+
+    /** Depth of the search of the position */
+    unsigned char depth = 0;
+
+    /** Bound of the value */
+    unsigned char bound = TranspositionBound::Exact;
+
+    /** Best action of the position */
+    GameAction action = { NO_PLACE, NO_PLACE };
+};
+
+/** Slot of the transposition table, the key is the hash of the position XOR the data */
+struct TranspositionSlot
+{
+    /** Hash of the position XOR the data */
+    std::atomic<unsigned long long> key;
+
+    /** Packed entry and generation */
+    std::atomic<unsigned long long> data;
+};
+
+/** Bucket of the transposition table (aligned to a cache line) */
+struct alignas(CACHE_LINE_SIZE) TranspositionBucket
+{
+    /** Slots of the bucket */
+    TranspositionSlot slots[TRANSPOSITION_BUCKET_SIZE];
+};
+
+/**
+ * Transposition table shared by the search threads
+ *
+ * The table is lock-free, the threads read and write the slots without
+ * locking. A slot stores the hash of its position XOR its data, so a
+ * slot written by two threads at once (with the key of one and the
+ * data of the other) does not verify and is a miss. The position is
+ * stored in the slot of its own, of an earlier search or of the
+ * shallowest search of its bucket.
+ */
+class TranspositionTable
+{
+private:
+    /** Memory of the buckets (aligned to a cache line inside) */
+    std::vector<unsigned char> memory;
+
+    /** Buckets of the table (number is power of 2) */
+    TranspositionBucket* buckets = nullptr;
+
+    /** Number of buckets */
+    std::size_t numOfBuckets = 0;
+
+    /** Generation of the current search */
+    unsigned char generation = 0;
+
+    /**
+     * Pack an entry
+     *
+     * @param[in] entry The entry
+     * @param[in] generation The generation of the search
+     *
+     * @return The data of the entry
+     */
+    static unsigned long long Pack(const TranspositionEntry& entry, unsigned char generation);
+
+    /**
+     * Unpack an entry
+     *
+     * @param[in] data The data of the entry
+     * @param[out] entry Pointer to store the entry in
+     */
+    static void Unpack(unsigned long long data, TranspositionEntry* entry);
+
+public:
+
+    /**
+     * Construct transposition table
+     */
+    TranspositionTable() = default;
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    /**
+     * Set the size of the table and clear it
+     *
+     * @param[in] megabytes Memory size of the table in megabytes (rounded down to power of 2 buckets)
+     *
+     * @return Allocation was successful
+     */
+    bool Resize(std::size_t megabytes);
+
+    /**
+     * Clear the table
+     *
+     * Not thread-safe, call between the searches.
+     */
+    void Clear();
+
+    /**
+     * Start a new search
+     *
+     * The entries of the earlier searches are replaced first.
+     */
+    void NewSearch();
+
+    /**
+     * Find the entry of a position
+     *
+     * @param[in] hash The hash of the position
+     * @param[out] entry Pointer to store the entry in
+     *
+     * @return The entry is found
+     */
+    bool Probe(unsigned long long hash, TranspositionEntry* entry) const;
+
+    /**
+     * Store the entry of a position
+     *
+     * @param[in] hash The hash of the position
+     * @param[in] entry The entry
+     */
+    void Store(unsigned long long hash, const TranspositionEntry& entry);
+
+    /**
+     * Get the number of entries
+     *
+     * @return The number of entries of the table
+     */
+    std::size_t GetSize() const;
+};
+
+inline std::size_t TranspositionTable::GetSize() const
+{
+    return numOfBuckets * TRANSPOSITION_BUCKET_SIZE;
+}
+
+#endif // TRANSPOSITION_TABLE_H
@@ -0,0 +1,902 @@
+/**
+ * Benchmark
+ * libMorris
+ *
+ * Measure the performance of the game core and the AI.
+ * Every result is written to the standard output as a JSON object per line.
+ *
+ * Usage: Benchmark [--quick] [--seed <seed>] [--max-storage <entries>] [--file <file name>]
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "../Game.hpp"
+#include "../GameBatch.hpp"
+#include "../LearningAI.hpp"
+#include "../MonteCarloAI.hpp"
+#include "../Random.hpp"
+#include "../SearchAI.hpp"
+#include "../SelfPlay.hpp"
+#include "../StorageFile.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Number of calls to measure the latency of GetNextStep with */
+const unsigned int BENCHMARK_NUM_OF_STEPS = 10000;
+
+/** Number of games to measure the latency of Store with */
+const unsigned int BENCHMARK_NUM_OF_STORES = 100;
+
+/** Number of games played at once by the batch benchmark */
+const unsigned int BENCHMARK_BATCH_SIZE = 256;
+
+/** Number of positions to measure the check throughput with */
+const unsigned int BENCHMARK_NUM_OF_POSITIONS = 1000;
+
+/** Benchmark options */
+struct BenchmarkOptions
+{
+    /** Run with smaller depths and counts */
+    bool quick = false;
+
+    /** Seed of the random number generators */
+    unsigned long long seed = 1;
+
+    /** Maximum number of entries in the storage */
+    unsigned long long maxStorageSize = 10000000;
+
+    /** Storage file to measure loading and saving with */
+    std::string fileName = "Benchmark.morris";
+};
+
+/** Timer measuring the elapsed time since its construction */
+class Timer
+{
+private:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    /**
+     * Get the elapsed time
+     *
+     * @return The seconds elapsed since the construction
+     */
+    double GetSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+/**
+ * Get the rate of a count
+ *
+ * @param[in] count The count
+ * @param[in] seconds The seconds elapsed
+ *
+ * @return The count per second
+ */
+double GetRate(double count, double seconds)
+{
+    return seconds > 0 ? count / seconds : 0;
+}
+
+/**
+ * Create a new game with a fixed starting player
+ *
+ * @param[in] seed The seed of the starting player
+ *
+ * @return The new game
+ */
+Game CreateGame(unsigned long long seed)
+{
+    Random random(seed);
+
+    return Game(&random);
+}
+
+/**
+ * Apply a random valid action
+ *
+ * @param[in,out] game The game to apply the action in
+ * @param[in,out] random The random number generator to select the action with
+ * @param[out] action Pointer to store the applied action in
+ *
+ * @return An action is applied
+ */
+bool ApplyRandomAction(Game* game, Random* random, GameAction* action = nullptr)
+{
+    GameActionList actions;
+    game->GetActions(&actions);
+    if (actions.size == 0)
+    {
+        return false;
+    }
+
+    GameAction selectedAction = actions.actions[random->Next(actions.size)];
+    if (action != nullptr)
+    {
+        *action = selectedAction;
+    }
+
+    return game->Apply(selectedAction);
+}
+
+/**
+ * Count the leaf nodes of the action tree
+ *
+ * @param[in,out] game The game to count from (restored before returning)
+ * @param[in] depth The depth of the tree
+ *
+ * @return The number of leaf nodes
+ */
+unsigned long long Perft(Game* game, unsigned int depth)
+{
+    if (depth == 0 || game->GetGameState() == GameState::End)
+    {
+        return 1;
+    }
+
+    GameActionList actions;
+    game->GetActions(&actions);
+    if (depth == 1)
+    {
+        return actions.size;
+    }
+
+    unsigned long long numOfNodes = 0;
+    for (unsigned char index = 0; index < actions.size; ++index)
+    {
+        GameUndo undo;
+        game->Apply(actions.actions[index], &undo);
+        numOfNodes += Perft(game, depth - 1);
+        game->Undo(undo);
+    }
+
+    return numOfNodes;
+}
+
+/**
+ * Collect positions of random games
+ *
+ * @param[in] seed The seed of the games
+ * @param[in] numOfPositions The number of positions to collect
+ *
+ * @return The positions
+ */
+std::vector<Game> CollectPositions(unsigned long long seed, unsigned int numOfPositions)
+{
+    std::vector<Game> positions;
+    positions.reserve(numOfPositions);
+
+    Random random(seed);
+    Game game = CreateGame(seed);
+    while (positions.size() < numOfPositions)
+    {
+        if (!ApplyRandomAction(&game, &random))
+        {
+            game = CreateGame(random.Next());
+            continue;
+        }
+
+        if (game.GetGameState() != GameState::End)
+        {
+            positions.push_back(game);
+        }
+    }
+
+    return positions;
+}
+
+/**
+ * Run the perft benchmark from a position
+ *
+ * @param[in] name The name of the position
+ * @param[in] game The position
+ * @param[in] depth The depth of the tree
+ */
+void BenchmarkPerft(const char* name, Game game, unsigned int depth)
+{
+    Timer timer;
+    unsigned long long numOfNodes = Perft(&game, depth);
+    double seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"perft\",\"position\":\"%s\",\"depth\":%u,\"nodes\":%llu,"
+                "\"seconds\":%.6f,\"nodesPerSecond\":%.0f}\n",
+                name, depth, numOfNodes, seconds, GetRate(numOfNodes, seconds));
+}
+
+/**
+ * Run the perft benchmarks
+ *
+ * The positions are fixed by the seed, the node counts can be compared between runs.
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkPerfts(const BenchmarkOptions& options)
+{
+    unsigned int depth = options.quick ? 3 : 5;
+
+    Game game = CreateGame(options.seed);
+    BenchmarkPerft("start", game, depth);
+
+    // Position in the middle of the placing phase
+    Random random(options.seed);
+    for (unsigned char step = 0; step < 8; ++step)
+    {
+        ApplyRandomAction(&game, &random);
+    }
+    BenchmarkPerft("place", game, depth);
+
+    // Position at the start of the moving phase
+    while (game.GetGameState() != GameState::Move)
+    {
+        if (!ApplyRandomAction(&game, &random) || game.GetGameState() == GameState::End)
+        {
+            game = CreateGame(random.Next());
+        }
+    }
+    BenchmarkPerft("move", game, depth + 1);
+}
+
+/**
+ * Run the random self-play benchmark
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkRandomGames(const BenchmarkOptions& options)
+{
+    unsigned int numOfGames = options.quick ? 1000 : 10000;
+    unsigned long long numOfSteps = 0;
+    unsigned int numOfFinishedGames = 0;
+
+    Random random(options.seed);
+    Timer timer;
+    for (unsigned int gameIndex = 0; gameIndex < numOfGames; ++gameIndex)
+    {
+        Game game = CreateGame(random.Next());
+        for (unsigned int step = 0; step < SELF_PLAY_MAX_NUM_OF_STEPS && ApplyRandomAction(&game, &random); ++step)
+        {
+            ++numOfSteps;
+        }
+
+        if (game.GetGameState() == GameState::End)
+        {
+            ++numOfFinishedGames;
+        }
+    }
+    double seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"randomGames\",\"games\":%u,\"finishedGames\":%u,\"steps\":%llu,"
+                "\"seconds\":%.6f,\"gamesPerSecond\":%.1f,\"stepsPerSecond\":%.0f}\n",
+                numOfGames, numOfFinishedGames, numOfSteps, seconds,
+                GetRate(numOfGames, seconds), GetRate(numOfSteps, seconds));
+}
+
+/**
+ * Run the batched random self-play benchmark
+ *
+ * Plays the same number of games as the random self-play benchmark,
+ * starting a new game in place of every finished one.
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkBatchGames(const BenchmarkOptions& options)
+{
+    unsigned int numOfGames = options.quick ? 1000 : 10000;
+    unsigned int numOfStartedGames = BENCHMARK_BATCH_SIZE;
+    unsigned long long numOfSteps = 0;
+    unsigned int numOfFinishedGames = 0;
+
+    Random random(options.seed);
+    GameBatch batch;
+    std::vector<GameBatchResult> finished;
+    Timer timer;
+    batch.Reset(BENCHMARK_BATCH_SIZE, &random, SELF_PLAY_MAX_NUM_OF_STEPS);
+    while (batch.GetNumberOfActiveGames() > 0)
+    {
+        finished.clear();
+        batch.Step(&random, &finished);
+        for (std::vector<GameBatchResult>::iterator ri = finished.begin(); ri != finished.end(); ++ri)
+        {
+            numOfSteps += ri->numOfSteps;
+            numOfFinishedGames += ri->winner != 0;
+
+            if (numOfStartedGames < numOfGames)
+            {
+                batch.Restart(ri->index, &random);
+                ++numOfStartedGames;
+            }
+        }
+    }
+    double seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"batchGames\",\"games\":%u,\"finishedGames\":%u,\"steps\":%llu,"
+                "\"seconds\":%.6f,\"gamesPerSecond\":%.1f,\"stepsPerSecond\":%.0f}\n",
+                numOfGames, numOfFinishedGames, numOfSteps, seconds,
+                GetRate(numOfGames, seconds), GetRate(numOfSteps, seconds));
+}
+
+/**
+ * Run the check benchmarks
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkChecks(const BenchmarkOptions& options)
+{
+    unsigned int numOfRounds = options.quick ? 100 : 1000;
+    std::vector<Game> positions = CollectPositions(options.seed, BENCHMARK_NUM_OF_POSITIONS);
+
+    // Count the valid results, so the calls can not be optimized away
+    unsigned long long numOfCalls = 0;
+    unsigned long long numOfValid = 0;
+    Timer timer;
+    for (unsigned int round = 0; round < numOfRounds; ++round)
+    {
+        for (std::vector<Game>::iterator pi = positions.begin(); pi != positions.end(); ++pi)
+        {
+            numOfValid += pi->CheckHasMove();
+        }
+    }
+    numOfCalls = static_cast<unsigned long long>(numOfRounds) * positions.size();
+    double seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"checkHasMove\",\"calls\":%llu,\"valid\":%llu,"
+                "\"seconds\":%.6f,\"callsPerSecond\":%.0f}\n",
+                numOfCalls, numOfValid, seconds, GetRate(numOfCalls, seconds));
+
+    numOfValid = 0;
+    timer = Timer();
+    for (unsigned int round = 0; round < numOfRounds; ++round)
+    {
+        for (std::vector<Game>::iterator pi = positions.begin(); pi != positions.end(); ++pi)
+        {
+            for (unsigned char place = 0; place < NUM_OF_FIELD_PLACES; ++place)
+            {
+                numOfValid += pi->CheckRemove(place);
+            }
+        }
+    }
+    numOfCalls = static_cast<unsigned long long>(numOfRounds) * positions.size() * NUM_OF_FIELD_PLACES;
+    seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"checkRemove\",\"calls\":%llu,\"valid\":%llu,"
+                "\"seconds\":%.6f,\"callsPerSecond\":%.0f}\n",
+                numOfCalls, numOfValid, seconds, GetRate(numOfCalls, seconds));
+}
+
+/**
+ * Run the alpha-beta search benchmark
+ *
+ * Search positions with one thread and with every hardware thread sharing the transposition table.
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkSearch(const BenchmarkOptions& options)
+{
+    unsigned char depth = options.quick ? 5 : 7;
+    std::vector<Game> positions = CollectPositions(options.seed, options.quick ? 10 : 50);
+    unsigned int numOfHardwareThreads = std::thread::hardware_concurrency();
+    std::vector<unsigned int> numsOfThreads = { 1 };
+    if (numOfHardwareThreads > 1)
+    {
+        numsOfThreads.push_back(numOfHardwareThreads);
+    }
+
+    for (std::vector<unsigned int>::const_iterator ti = numsOfThreads.cbegin(); ti != numsOfThreads.cend(); ++ti)
+    {
+        Game game = CreateGame(options.seed);
+        SearchAI ai;
+        ai.Initialize(&game);
+        ai.SetThreads(*ti);
+
+        unsigned long long numOfNodes = 0;
+        double seconds = 0;
+        for (std::vector<Game>::const_iterator pi = positions.cbegin(); pi != positions.cend(); ++pi)
+        {
+            game = *pi;
+            ai.Clear();
+
+            Timer timer;
+            ai.GetBestAction(depth);
+            seconds += timer.GetSeconds();
+            numOfNodes += ai.GetNumberOfNodes();
+        }
+
+        std::printf("{\"benchmark\":\"search\",\"threads\":%u,\"depth\":%u,\"positions\":%zu,\"nodes\":%llu,"
+                    "\"seconds\":%.6f,\"nodesPerSecond\":%.0f}\n",
+                    *ti, depth, positions.size(), numOfNodes, seconds, GetRate(numOfNodes, seconds));
+    }
+}
+
+/**
+ * Run the Monte Carlo tree search benchmark
+ *
+ * Search the start position with one thread and with every hardware thread.
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkMonteCarlo(const BenchmarkOptions& options)
+{
+    double seconds = options.quick ? 0.5 : 2;
+    unsigned int numOfHardwareThreads = std::thread::hardware_concurrency();
+    std::vector<unsigned int> numsOfThreads = { 1 };
+    if (numOfHardwareThreads > 1)
+    {
+        numsOfThreads.push_back(numOfHardwareThreads);
+    }
+
+    for (std::vector<unsigned int>::const_iterator ti = numsOfThreads.cbegin(); ti != numsOfThreads.cend(); ++ti)
+    {
+        Game game = CreateGame(options.seed);
+        MonteCarloAI ai;
+        ai.Initialize(&game, *ti);
+
+        Timer timer;
+        ai.GetBestAction(seconds);
+        double searchSeconds = timer.GetSeconds();
+
+        std::printf("{\"benchmark\":\"monteCarlo\",\"threads\":%u,\"iterations\":%llu,\"nodes\":%u,"
+                    "\"seconds\":%.6f,\"iterationsPerSecond\":%.0f}\n",
+                    *ti, ai.GetNumberOfIterations(), ai.GetNumberOfNodes(), searchSeconds,
+                    GetRate(ai.GetNumberOfIterations(), searchSeconds));
+    }
+}
+
+/**
+ * Play a random game registered by the AI
+ *
+ * The AI gets the next steps, but the actions are random.
+ *
+ * @param[in,out] ai The AI to register the steps of the game in
+ * @param[in,out] game The game of the AI
+ * @param[in,out] random The random number generator to play the game with
+ *
+ * @return The number of steps of the game
+ */
+unsigned int PlayRegisteredGame(LearningAI* ai, Game* game, Random* random)
+{
+    *game = CreateGame(random->Next());
+    GameAction action;
+    unsigned int numOfSteps = 0;
+    while (numOfSteps < SELF_PLAY_MAX_NUM_OF_STEPS && game->GetGameState() != GameState::End)
+    {
+        ai->GetNextStep();
+        if (!ApplyRandomAction(game, random, &action))
+        {
+            break;
+        }
+        ai->Register({ action.from, action.to });
+        ++numOfSteps;
+    }
+
+    return numOfSteps;
+}
+
+/**
+ * Store a random step of every position
+ *
+ * The positions get stored steps like the positions of trained storages,
+ * so getting the next step in them finds the storage.
+ *
+ * @param[in,out] ai The AI to store the steps in
+ * @param[in] positions The positions to store a step of
+ * @param[in,out] random The random number generator to select the steps with
+ */
+void StorePositions(LearningAI* ai, const std::vector<Game>& positions, Random* random)
+{
+    Game game;
+    LearningAI collector;
+    collector.Initialize(&game);
+
+    std::vector<GameStepElement> steps;
+    GameAction action;
+    for (std::vector<Game>::const_iterator pi = positions.cbegin(); pi != positions.cend(); ++pi)
+    {
+        game = *pi;
+        collector.GetNextStep();
+        if (ApplyRandomAction(&game, random, &action))
+        {
+            collector.Register({ action.from, action.to });
+            collector.Collect(random->Next(2) == 0, &steps);
+        }
+    }
+
+    ai->Merge(steps);
+}
+
+/**
+ * Fill the storage with the steps of random games
+ *
+ * The games are registered by a collecting AI and merged in chunks, until
+ * the storage has the number of steps (the steps of the games repeat).
+ *
+ * @param[in,out] ai The AI to fill the storage of
+ * @param[in,out] random The random number generator to play the games with
+ * @param[in] storageSize The number of steps of the storage to fill up to
+ */
+void FillStorage(LearningAI* ai, Random* random, unsigned long long storageSize)
+{
+    const unsigned int chunkSize = 100000;
+
+    Game game;
+    LearningAI collector;
+    collector.Initialize(&game);
+
+    std::vector<GameStepElement> steps;
+    steps.reserve(chunkSize + SELF_PLAY_MAX_NUM_OF_STEPS);
+    for (unsigned long long numOfSteps = ai->GetNumberOfSteps(); numOfSteps < storageSize;
+            numOfSteps = ai->GetNumberOfSteps())
+    {
+        // Fill at most the missing steps in a chunk, the repeated ones are merged
+        unsigned long long numOfChunkSteps = storageSize - numOfSteps < chunkSize ? storageSize - numOfSteps : chunkSize;
+        while (steps.size() < numOfChunkSteps)
+        {
+            PlayRegisteredGame(&collector, &game, random);
+            collector.Collect(random->Next(2) == 0, &steps);
+        }
+
+        ai->Merge(steps);
+        steps.clear();
+    }
+}
+
+/**
+ * Count the calls getting a stored step
+ *
+ * A call gets a stored step if an action of its position is stored.
+ *
+ * @param[in,out] ai The AI to look up the steps with
+ * @param[in,out] game The game of the AI
+ * @param[in] positions The positions of the calls (one after the other)
+ * @param[in] numOfCalls The number of calls
+ *
+ * @return The number of calls getting a stored step
+ */
+unsigned int CountStoredCalls(LearningAI* ai, Game* game, const std::vector<Game>& positions, unsigned int numOfCalls)
+{
+    unsigned int numOfStoredCalls = 0;
+    for (unsigned int index = 0; index < numOfCalls; ++index)
+    {
+        *game = positions[index % positions.size()];
+
+        GameActionList actions;
+        game->GetActions(&actions);
+        unsigned int wins;
+        unsigned int losses;
+        for (unsigned char action = 0; action < actions.size; ++action)
+        {
+            if (ai->GetStepResults(actions.actions[action], &wins, &losses))
+            {
+                ++numOfStoredCalls;
+                break;
+            }
+        }
+    }
+
+    return numOfStoredCalls;
+}
+
+/**
+ * Run the storage benchmarks with the current size of the storage
+ *
+ * @param[in,out] ai The AI to measure
+ * @param[in,out] game The game of the AI
+ * @param[in] positions The positions to get the next step in
+ * @param[in,out] random The random number generator to play the games with
+ */
+void BenchmarkStorageLatency(LearningAI* ai, Game* game, const std::vector<Game>& positions, Random* random)
+{
+    unsigned long long storageSize = ai->GetNumberOfSteps();
+    unsigned int numOfHits = CountStoredCalls(ai, game, positions, BENCHMARK_NUM_OF_STEPS);
+    Timer timer;
+    for (unsigned int index = 0; index < BENCHMARK_NUM_OF_STEPS; ++index)
+    {
+        *game = positions[index % positions.size()];
+        ai->GetNextStep();
+    }
+    double seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"getNextStep\",\"storage\":%llu,\"calls\":%u,\"hits\":%u,\"misses\":%u,"
+                "\"seconds\":%.6f,\"microsecondsPerCall\":%.3f}\n",
+                storageSize, BENCHMARK_NUM_OF_STEPS, numOfHits, BENCHMARK_NUM_OF_STEPS - numOfHits, seconds,
+                seconds * 1e6 / BENCHMARK_NUM_OF_STEPS);
+
+    // Play the games outside of the measurement, only the storing is measured
+    unsigned long long numOfSteps = 0;
+    seconds = 0;
+    for (unsigned int gameIndex = 0; gameIndex < BENCHMARK_NUM_OF_STORES; ++gameIndex)
+    {
+        numOfSteps += PlayRegisteredGame(ai, game, random);
+
+        Timer storeTimer;
+        ai->Store(random->Next(2) == 0);
+        seconds += storeTimer.GetSeconds();
+    }
+
+    std::printf("{\"benchmark\":\"store\",\"storage\":%llu,\"calls\":%u,\"steps\":%llu,"
+                "\"seconds\":%.6f,\"microsecondsPerCall\":%.3f,\"microsecondsPerStep\":%.3f}\n",
+                storageSize, BENCHMARK_NUM_OF_STORES, numOfSteps, seconds,
+                seconds * 1e6 / BENCHMARK_NUM_OF_STORES, numOfSteps > 0 ? seconds * 1e6 / numOfSteps : 0);
+}
+
+/**
+ * Run the background store benchmark
+ *
+ * Store the games in background mode with saving after every quarter of
+ * them. Only the calls of the playing thread are measured, stopping
+ * applies and saves the rest.
+ *
+ * @param[in,out] ai The AI to store the games of
+ * @param[in,out] game The game of the AI
+ * @param[in] options The benchmark options
+ * @param[in,out] random The random number generator to play the games with
+ */
+void BenchmarkBackgroundStore(LearningAI* ai, Game* game, const BenchmarkOptions& options, Random* random)
+{
+    unsigned long long storageSize = ai->GetNumberOfSteps();
+    ai->StartBackground(options.fileName, BENCHMARK_NUM_OF_STORES / 4);
+
+    unsigned long long numOfSteps = 0;
+    double seconds = 0;
+    for (unsigned int gameIndex = 0; gameIndex < BENCHMARK_NUM_OF_STORES; ++gameIndex)
+    {
+        numOfSteps += PlayRegisteredGame(ai, game, random);
+
+        Timer storeTimer;
+        ai->Store(random->Next(2) == 0);
+        seconds += storeTimer.GetSeconds();
+    }
+
+    Timer stopTimer;
+    bool saved = ai->StopBackground();
+    double stopSeconds = stopTimer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"backgroundStore\",\"storage\":%llu,\"calls\":%u,\"steps\":%llu,\"success\":%s,"
+                "\"seconds\":%.6f,\"microsecondsPerCall\":%.3f,\"stopSeconds\":%.6f}\n",
+                storageSize, BENCHMARK_NUM_OF_STORES, numOfSteps, saved ? "true" : "false", seconds,
+                seconds * 1e6 / BENCHMARK_NUM_OF_STORES, stopSeconds);
+}
+
+/**
+ * Run the save and load benchmark
+ *
+ * The rates are calculated with the number of entries actually saved (the
+ * store benchmarks before grow the storage). Mapped and compressed files
+ * are only mapped by loading, so their loading is reported as the latency
+ * of opening and the rates are measured by reading every record of the
+ * file.
+ *
+ * @param[in,out] ai The AI to save the storage of
+ * @param[in] options The benchmark options
+ * @param[in] format The format of the storage file
+ */
+void BenchmarkSaveLoad(LearningAI* ai, const BenchmarkOptions& options, StorageFormat format)
+{
+    const char* formatName = format == StorageFormat::Compressed ? "compressed"
+                             : format == StorageFormat::Mapped ? "mapped" : "raw";
+
+    // Save a copy, saving in mapped or compressed format replaces the storage of the AI
+    Game game = CreateGame(options.seed);
+    LearningAI savingAI;
+    savingAI.Initialize(&game);
+    if (!ai->Save(options.fileName) || !savingAI.Load(options.fileName))
+    {
+        std::fprintf(stderr, "Saving storage file \"%s\" failed.\n", options.fileName.c_str());
+        return;
+    }
+    unsigned long long storageSize = savingAI.GetNumberOfSteps();
+
+    Timer timer;
+    bool saved = savingAI.Save(options.fileName, format);
+    double seconds = timer.GetSeconds();
+
+    std::FILE* file = std::fopen(options.fileName.c_str(), "rb");
+    long fileSize = 0;
+    if (file != nullptr)
+    {
+        std::fseek(file, 0, SEEK_END);
+        fileSize = std::ftell(file);
+        std::fclose(file);
+    }
+
+    std::printf("{\"benchmark\":\"save\",\"format\":\"%s\",\"storage\":%llu,\"success\":%s,\"bytes\":%ld,"
+                "\"seconds\":%.6f,\"entriesPerSecond\":%.0f,\"megabytesPerSecond\":%.3f}\n",
+                formatName, storageSize, saved ? "true" : "false", fileSize, seconds,
+                GetRate(storageSize, seconds), GetRate(fileSize / 1e6, seconds));
+
+    LearningAI loadingAI;
+    loadingAI.Initialize(&game);
+    timer = Timer();
+    bool loaded = loadingAI.Load(options.fileName);
+    seconds = timer.GetSeconds();
+
+    if (format == StorageFormat::Raw)
+    {
+        std::printf("{\"benchmark\":\"load\",\"format\":\"%s\",\"storage\":%llu,\"success\":%s,\"bytes\":%ld,"
+                    "\"seconds\":%.6f,\"entriesPerSecond\":%.0f,\"megabytesPerSecond\":%.3f}\n",
+                    formatName, storageSize, loaded ? "true" : "false", fileSize, seconds,
+                    GetRate(storageSize, seconds), GetRate(fileSize / 1e6, seconds));
+        return;
+    }
+
+    std::printf("{\"benchmark\":\"load\",\"format\":\"%s\",\"storage\":%llu,\"success\":%s,\"bytes\":%ld,"
+                "\"openSeconds\":%.6f}\n",
+                formatName, storageSize, loaded ? "true" : "false", fileSize, seconds);
+
+    // Sum the counters, so the reads can not be optimized away
+    StorageFile storageFile;
+    unsigned long long numOfResults = 0;
+    timer = Timer();
+    bool opened = storageFile.Open(options.fileName);
+    for (std::size_t index = 0; index < storageFile.GetNumberOfRecords(); ++index)
+    {
+        StorageFileRecord record = storageFile.GetRecord(index);
+        numOfResults += record.wins + record.losses;
+    }
+    seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"read\",\"format\":\"%s\",\"storage\":%zu,\"success\":%s,\"bytes\":%ld,"
+                "\"results\":%llu,\"seconds\":%.6f,\"entriesPerSecond\":%.0f,\"megabytesPerSecond\":%.3f}\n",
+                formatName, storageFile.GetNumberOfRecords(), opened ? "true" : "false", fileSize, numOfResults, seconds,
+                GetRate(storageFile.GetNumberOfRecords(), seconds), GetRate(fileSize / 1e6, seconds));
+}
+
+/**
+ * Run the best step table benchmark
+ *
+ * Export the storage to a best step table and measure getting the next
+ * step with the table instead of the storage. The table has a step of the
+ * positions stored, the others are played randomly.
+ *
+ * @param[in,out] ai The AI to export the storage of
+ * @param[in,out] aiGame The game of the AI
+ * @param[in] positions The positions to get the next step in
+ */
+void BenchmarkBestStepTable(LearningAI* ai, Game* aiGame, const std::vector<Game>& positions)
+{
+    unsigned long long storageSize = ai->GetNumberOfSteps();
+    unsigned int numOfHits = CountStoredCalls(ai, aiGame, positions, BENCHMARK_NUM_OF_STEPS);
+    BestStepTable table;
+    Timer timer;
+    bool exported = ai->ExportBestSteps(&table);
+    double seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"exportBestSteps\",\"storage\":%llu,\"success\":%s,\"states\":%zu,"
+                "\"bytes\":%zu,\"seconds\":%.6f}\n",
+                storageSize, exported ? "true" : "false", table.GetNumberOfSteps(), table.GetMemorySize(), seconds);
+
+    Game game;
+    LearningAI tableAI;
+    tableAI.Initialize(&game);
+    tableAI.SetBestStepTable(&table);
+    timer = Timer();
+    for (unsigned int index = 0; index < BENCHMARK_NUM_OF_STEPS; ++index)
+    {
+        game = positions[index % positions.size()];
+        tableAI.GetNextStep();
+    }
+    seconds = timer.GetSeconds();
+
+    std::printf("{\"benchmark\":\"getNextStepTable\",\"storage\":%llu,\"calls\":%u,\"hits\":%u,\"misses\":%u,"
+                "\"seconds\":%.6f,\"microsecondsPerCall\":%.3f}\n",
+                storageSize, BENCHMARK_NUM_OF_STEPS, numOfHits, BENCHMARK_NUM_OF_STEPS - numOfHits, seconds,
+                seconds * 1e6 / BENCHMARK_NUM_OF_STEPS);
+}
+
+/**
+ * Run the storage benchmarks
+ *
+ * The storage grows by a factor of 10 from 10000 entries up to the maximum
+ * size, filled with the steps of random games and a step of every measured
+ * position, so getting the next step finds the storage like in trained
+ * storages.
+ *
+ * @param[in] options The benchmark options
+ */
+void BenchmarkStorage(const BenchmarkOptions& options)
+{
+    std::vector<Game> positions = CollectPositions(options.seed, BENCHMARK_NUM_OF_POSITIONS);
+
+    Random random(options.seed);
+    Game game = CreateGame(options.seed);
+    LearningAI ai;
+    ai.Initialize(&game);
+    ai.Seed(options.seed);
+
+    // The stored games add steps too, fill only up to the size (every benchmark reports the size it measured)
+    StorePositions(&ai, positions, &random);
+    for (unsigned long long size = 10000; size <= options.maxStorageSize; size *= 10)
+    {
+        FillStorage(&ai, &random, size);
+
+        BenchmarkStorageLatency(&ai, &game, positions, &random);
+        BenchmarkBackgroundStore(&ai, &game, options, &random);
+        BenchmarkSaveLoad(&ai, options, StorageFormat::Raw);
+        BenchmarkSaveLoad(&ai, options, StorageFormat::Mapped);
+        BenchmarkSaveLoad(&ai, options, StorageFormat::Compressed);
+        BenchmarkBestStepTable(&ai, &game, positions);
+    }
+
+#if defined(MORRIS_STATISTICS)
+    LearningAIStatistics statistics = ai.GetStatistics();
+    std::printf("{\"benchmark\":\"storageStatistics\",\"lookups\":%llu,\"storageHits\":%llu,\"fileHits\":%llu,"
+                "\"misses\":%llu,\"retries\":%llu,\"stores\":%llu,\"storeSeconds\":%.6f,\"saves\":%llu,"
+                "\"saveSeconds\":%.6f,\"storageSteps\":%zu,\"storageMemory\":%zu}\n",
+                statistics.numOfLookups.Get(), statistics.numOfStorageHits.Get(), statistics.numOfFileHits.Get(),
+                statistics.numOfMisses.Get(), statistics.numOfRetries.Get(), statistics.numOfStores.Get(),
+                statistics.storeNanoseconds / 1e9, statistics.numOfSaves.Get(), statistics.saveNanoseconds / 1e9,
+                statistics.numOfStorageSteps,
+                statistics.storageMemory);
+#endif
+
+    std::remove(options.fileName.c_str());
+}
+
+/**
+ * Parse the command line options
+ *
+ * @param[in] argc The number of arguments
+ * @param[in] argv The arguments
+ * @param[out] options Pointer to the options to store the parsed ones in
+ *
+ * @return The options are valid
+ */
+bool ParseOptions(int argc, char* argv[], BenchmarkOptions* options)
+{
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--quick") == 0)
+        {
+            options->quick = true;
+            options->maxStorageSize = 100000;
+        }
+        else if (std::strcmp(argv[index], "--seed") == 0 && index + 1 < argc)
+        {
+            options->seed = std::strtoull(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--max-storage") == 0 && index + 1 < argc)
+        {
+            options->maxStorageSize = std::strtoull(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--file") == 0 && index + 1 < argc)
+        {
+            options->fileName = argv[++index];
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        std::fprintf(stderr, "Usage: %s [--quick] [--seed <seed>] [--max-storage <entries>] [--file <file name>]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    BenchmarkPerfts(options);
+    BenchmarkRandomGames(options);
+    BenchmarkBatchGames(options);
+    BenchmarkChecks(options);
+    BenchmarkSearch(options);
+    BenchmarkMonteCarlo(options);
+    BenchmarkStorage(options);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/**
+ * Merge
+ * libMorris
+ *
+ * Merge AI storage files (for example the ones of several machines)
+ * into one, adding up the wins and losses of the same game steps.
+ * The memory used is bounded, the records over the limit are sorted
+ * in temporary files.
+ *
+ * Usage: Merge [--format <raw|mapped|compressed>] [--memory <records>] [--temp <directory>] <output file> <input file>...
+ *
+ * @author Tibor Buzási <develop@tiborbuzasi.com>
+ *
+ * Copyright © 2020 Tibor Buzási. All rights reserved.
+ * For licensing information see LICENSE in the project root folder.
+ */
+
+#include "../LearningAI.hpp"
+#include "../StorageMerge.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/** Merge options */
+struct MergeOptions
+{
+    /** Format of the output file */
+    StorageFormat format = StorageFormat::Mapped;
+
+    /** Maximum number of records kept in memory */
+    unsigned long long maxNumOfRecords = STORAGE_MERGE_MAX_NUM_OF_RECORDS;
+
+    /** Directory of the temporary files */
+    std::string temporaryDirectory;
+
+    /** Filename of the output file */
+    std::string outputFileName;
+
+    /** Filenames of the input files */
+    std::vector<std::string> inputFileNames;
+};
+
+/**
+ * Parse the command line options
+ *
+ * @param[in] argc The number of arguments
+ * @param[in] argv The arguments
+ * @param[out] options Pointer to store the options in
+ *
+ * @return The options are valid
+ */
+bool ParseOptions(int argc, char* argv[], MergeOptions* options)
+{
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--format") == 0 && index + 1 < argc)
+        {
+            ++index;
+            if (std::strcmp(argv[index], "raw") == 0)
+            {
+                options->format = StorageFormat::Raw;
+            }
+            else if (std::strcmp(argv[index], "mapped") == 0)
+            {
+                options->format = StorageFormat::Mapped;
+            }
+            else if (std::strcmp(argv[index], "compressed") == 0)
+            {
+                options->format = StorageFormat::Compressed;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (std::strcmp(argv[index], "--memory") == 0 && index + 1 < argc)
+        {
+            options->maxNumOfRecords = std::strtoull(argv[++index], nullptr, 10);
+        }
+        else if (std::strcmp(argv[index], "--temp") == 0 && index + 1 < argc)
+        {
+            options->temporaryDirectory = argv[++index];
+        }
+        else if (argv[index][0] == '-')
+        {
+            return false;
+        }
+        else if (options->outputFileName.empty())
+        {
+            options->outputFileName = argv[index];
+        }
+        else
+        {
+            options->inputFileNames.push_back(argv[index]);
+        }
+    }
+
+    return !options->inputFileNames.empty() && options->maxNumOfRecords > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    MergeOptions options;
+    if (!ParseOptions(argc, argv, &options))
+    {
+        std::fprintf(stderr, "Usage: %s [--format <raw|mapped|compressed>] [--memory <records>] [--temp <directory>] "
+                     "<output file> <input file>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    StorageMerge merge(options.temporaryDirectory, options.maxNumOfRecords);
+    for (std::vector<std::string>::const_iterator fi = options.inputFileNames.cbegin();
+            fi != options.inputFileNames.cend(); ++fi)
+    {
+        if (!LearningAI::MergeFile(*fi, &merge))
+        {
+            std::fprintf(stderr, "Reading storage file \"%s\" failed.\n", fi->c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!merge.Write(options.outputFileName, options.format))
+    {
+        std::fprintf(stderr, "Writing storage file \"%s\" failed.\n", options.outputFileName.c_str());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}